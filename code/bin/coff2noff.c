@@ -69,6 +69,10 @@ ShortToHost(unsigned short shortword) {
 
 #define ReadStruct(f,s)		Read(f,&s,sizeof(s))
 
+#ifdef CHANGED
+#define PageSize	128	/* must match machine/machine.h */
+#endif
+
 char *noffFileName = NULL;
 
 /* read and check for error */
@@ -181,6 +185,32 @@ int main (int argc, char **argv)
             Write(fdOut, buffer, sections[i].s_size);
             free(buffer);
             inNoffFile += sections[i].s_size;
+#ifdef CHANGED
+            /* Pad the code to a page boundary, so that no page holds both
+             * code and data: the kernel can then share the code pages
+             * between all the processes running this executable. */
+            if (noffH.code.size % PageSize != 0) {
+                int end = noffH.code.virtualAddr + noffH.code.size;
+                int padding = PageSize - noffH.code.size % PageSize;
+                int j, collides = 0;
+
+                for (j = 0; j < numsections; j++)
+                    if (j != i && sections[j].s_size != 0
+                        && sections[j].s_paddr >= noffH.code.virtualAddr
+                        && sections[j].s_paddr < end + padding)
+                        collides = 1;
+                if (collides) {
+                    fprintf(stderr, "Warning: data shares the last code page, "
+                            "it will not be shared between processes\n");
+                } else {
+                    buffer = calloc(padding, 1);
+                    Write(fdOut, buffer, padding);
+                    free(buffer);
+                    noffH.code.size += padding;
+                    inNoffFile += padding;
+                }
+            }
+#endif
         } else if (!strcmp(sections[i].s_name, ".data")
                           || !strcmp(sections[i].s_name, ".rdata")) {
             /* need to check if we have both .data and .rdata
@@ -31,6 +31,9 @@ OpenFile::OpenFile(int sector)
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
     seekPosition = 0;
+#ifdef CHANGED
+    hdrSector = sector;
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -53,6 +53,12 @@ class OpenFile:public dontcopythis {
 
     int Length(void) { Lseek(file, 0, SEEK_END); return Tell(file); }
 
+#ifdef CHANGED
+    int HeaderSector(void) { return FileId(file); }
+                                        // No header here: the host inode
+                                        // identifies the file instead
+#endif
+
   private:
     int file;
     int currentOffset;
@@ -87,8 +93,16 @@ class OpenFile:public dontcopythis {
                                         // than the UNIX idiom -- lseek to
                                         // end of file, tell, lseek back
 
+#ifdef CHANGED
+    int HeaderSector(void)              // Sector of the file header, which
+      { return hdrSector; }             // identifies the file
+#endif
+
   private:
     FileHeader *hdr;                    // Header for this file
+#ifdef CHANGED
+    int hdrSector;                      // Where "hdr" lives on disk
+#endif
     int seekPosition;                   // Current position within the file
 };
 
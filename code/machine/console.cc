@@ -63,9 +63,15 @@ Console::Console(const char *readFile, const char *writeFile, VoidFunctionPtr re
     handlerArg = callArg;
     putBusy = FALSE;
     incoming = NOCHAR;
+#ifdef CHANGED
+    outputCount = 0;
+#endif
 
     // start polling for incoming packets
     interrupt->Schedule(ConsoleReadPoll, this, ConsoleTime, ConsoleReadInt);
+#ifdef CHANGED
+    interrupt->WatchFile(readFileNo);
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -75,11 +81,17 @@ Console::Console(const char *readFile, const char *writeFile, VoidFunctionPtr re
 
 Console::~Console()
 {
+#ifdef CHANGED
+    interrupt->UnwatchFile(readFileNo);
+#endif
     if (readFileNo != 0)
         Close(readFileNo);
     else
         stdin_busy = 0;
     readFileNo = -1;
+#ifdef CHANGED
+    FlushOutput();
+#endif
     if (writeFileNo != 1)
         Close(writeFileNo);
     writeFileNo = -1;
@@ -180,8 +192,31 @@ Console::WriteDone()
     putBusy = FALSE;
     stats->numConsoleCharsWritten++;
     (*writeHandler)(handlerArg);
+#ifdef CHANGED
+    if (!putBusy)
+        FlushOutput();          // the display went idle
+#endif
 }
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// Console::FlushOutput()
+//	Write the characters gathered by TX to the UNIX file, in a single
+//	write.  Called on a newline, when the buffer is full, when the
+//	display goes idle, and when the console is deleted.
+//----------------------------------------------------------------------
+
+void
+Console::FlushOutput()
+{
+    if (outputCount == 0)
+        return;
+    WriteFile(writeFileNo, output, outputCount);
+    stats->numConsoleHostWrites++;
+    outputCount = 0;
+}
+#endif
+
 //----------------------------------------------------------------------
 // Console::RX()
 //	Read a character from the input buffer, if there is any there.
@@ -209,7 +244,9 @@ Console::RX()
 void
 Console::TX(int ch)
 {
+#ifndef CHANGED
     unsigned char c;
+#endif
 
     ASSERT_MSG(putBusy == FALSE, "We are already sending a character\n");
 
@@ -221,6 +258,21 @@ Console::TX(int ch)
     if (ch < 0 && ch >= -128)
         ch += 256;
 
+#ifdef CHANGED
+    // Gather the bytes, the simulated latency stays per character
+    if (outputCount + 2 > ConsoleHostBufferSize)
+        FlushOutput();
+    if (ch < 0x80 || strcmp(nl_langinfo(CODESET),"UTF-8")) {
+        /* Not UTF-8 or ASCII, assume 8bit locale */
+        output[outputCount++] = ch;
+    } else if (ch < 0x100) {
+        /* Non-ASCII UTF-8, thus two bytes */
+        output[outputCount++] = ((ch & 0xc0) >> 6) | 0xc0;
+        output[outputCount++] = (ch & 0x3f) | 0x80;
+    } /* Else not latin1, drop */
+    if (ch == '\n')
+        FlushOutput();
+#else
     if (ch < 0x80 || strcmp(nl_langinfo(CODESET),"UTF-8")) {
         /* Not UTF-8 or ASCII, assume 8bit locale */
         c = ch;
@@ -232,6 +284,7 @@ Console::TX(int ch)
         c = (ch & 0x3f) | 0x80;
         WriteFile(writeFileNo, &c, sizeof(c));
     } /* Else not latin1, drop */
+#endif
     putBusy = TRUE;
     interrupt->Schedule(ConsoleWriteDone, this, ConsoleTime,
                                         ConsoleWriteInt);
@@ -27,6 +27,11 @@
 #include "utility.h"
 #include <stdio.h>
 
+#ifdef CHANGED
+#define ConsoleHostBufferSize	4096	// output bytes gathered before
+					// writing them to the UNIX file
+#endif
+
 // The following class defines a hardware console device.
 // Input and output to the device is simulated by reading
 // and writing to UNIX files ("readFile" and "writeFile").
@@ -63,6 +68,9 @@ class Console:public dontcopythis {
 // internal emulation routines -- DO NOT call these.
     void WriteDone(void);	// internal routines to signal I/O completion
     void CheckCharAvail(void);
+#ifdef CHANGED
+    void FlushOutput(void);	// write the gathered output to the UNIX file
+#endif
 
   private:
     int readFileNo;                     // UNIX file emulating the keyboard
@@ -80,6 +88,10 @@ class Console:public dontcopythis {
                                         // Otherwise contains EOF.
     static int stdin_busy;              // Whether stdin is already read from
                                         // by a console.
+#ifdef CHANGED
+    char output[ConsoleHostBufferSize]; // Characters "put" but not yet
+    int outputCount;                    // written to the UNIX file
+#endif
 };
 
 #endif // CONSOLE_H
@@ -65,6 +65,9 @@ Interrupt::Interrupt()
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
+#ifdef CHANGED
+    numWatchedFiles = 0;
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -166,6 +169,10 @@ Interrupt::OneTick()
         stats->totalTicks += UserTick;
         stats->userTicks += UserTick;
     }
+#if defined(USER_PROGRAM) && defined(CHANGED)
+    if (kernelinfo != NULL)
+        kernelinfo->Tick();
+#endif
     DEBUG('i', "\n== Tick %lld ==\n", stats->totalTicks);
 
 // check any pending interrupts are now ready to fire
@@ -218,6 +225,10 @@ Interrupt::Idle()
 {
     DEBUG('i', "Machine idling; checking for interrupts.\n");
     status = IdleMode;
+#ifdef CHANGED
+    if (OnlyPollsPending())
+        WaitForInput();                 // instead of spinning on the polls
+#endif
     if (CheckIfDue(TRUE)) {             // check for any pending interrupts
         while (CheckIfDue(FALSE))       // check for any other pending
             ;                                // interrupts
@@ -383,3 +394,74 @@ Interrupt::DumpState()
     printf("End of pending interrupts\n");
     fflush(stdout);
 }
+
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// Interrupt::WatchFile
+// Interrupt::UnwatchFile
+//	Record which UNIX files the console and the network poll, so that
+//	the idle loop can wait on them, and so that polls only ask the host
+//	after it signalled input on them.
+//----------------------------------------------------------------------
+
+void
+Interrupt::WatchFile(int fd)
+{
+    ASSERT(numWatchedFiles < MaxWatchedFiles);
+    watchedFiles[numWatchedFiles++] = fd;
+    StartAsyncInput(fd);
+}
+
+void
+Interrupt::UnwatchFile(int fd)
+{
+    StopAsyncInput(fd);
+    for (int i = 0; i < numWatchedFiles; i++)
+        if (watchedFiles[i] == fd) {
+            watchedFiles[i] = watchedFiles[--numWatchedFiles];
+            return;
+        }
+}
+
+//----------------------------------------------------------------------
+// Interrupt::OnlyPollsPending
+//	Return TRUE if the only pending interrupts are the console and
+//	network polls.  Then, until something arrives on a watched file,
+//	every one of them would find nothing.
+//----------------------------------------------------------------------
+
+bool
+Interrupt::OnlyPollsPending()
+{
+    ListElement *element;
+
+    if (pending->IsEmpty() || numWatchedFiles == 0)
+        return FALSE;
+    for (element = pending->FirstElement(); element; element = element->next) {
+        PendingInterrupt *p = (PendingInterrupt *) element->item;
+        if (p->type != ConsoleReadInt && p->type != NetworkRecvInt)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::WaitForInput
+//	Block the host process until a watched file is readable, or for
+//	IdleWaitUsecs at most.  Simulated time advances by the idle polls
+//	that would have run meanwhile: each of them slept in PollFile.
+//----------------------------------------------------------------------
+
+void
+Interrupt::WaitForInput()
+{
+    long long waited = WaitForFiles(watchedFiles, numWatchedFiles,
+                                    IdleWaitUsecs);
+    long long ticks = waited / IdlePollUsecs * ConsoleTime;
+
+    DEBUG('i', "Waited %lld us for input, skipping %lld ticks\n",
+          waited, ticks);
+    stats->idleTicks += ticks;
+    stats->totalTicks += ticks;
+}
+#endif
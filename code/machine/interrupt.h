@@ -49,6 +49,12 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 // IntType records which hardware device generated an interrupt.
 // In Nachos, we support a hardware timer device, a disk, a console
 // display and keyboard, and a network.
+#ifdef CHANGED
+#define MaxWatchedFiles		4	// UNIX files the idle loop waits on
+#define IdleWaitUsecs		1000000	// longest host wait, so that user
+					// aborts are still noticed
+#endif
+
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt,
                                 NetworkSendInt, NetworkRecvInt};
 
@@ -114,6 +120,11 @@ class Interrupt:public dontcopythis {
 
     void OneTick(void);                 // Advance simulated time
 
+#ifdef CHANGED
+    void WatchFile(int fd);             // A device polls UNIX file "fd"
+    void UnwatchFile(int fd);           // It does not any more
+#endif
+
   private:
     IntStatus level;                    // are interrupts enabled or disabled?
     List *pending;                      // the list of interrupts scheduled
@@ -130,6 +141,16 @@ class Interrupt:public dontcopythis {
 
     void ChangeLevel(IntStatus old,     // SetLevel, without advancing the
         IntStatus now);                 // simulated time
+
+#ifdef CHANGED
+    int watchedFiles[MaxWatchedFiles];  // UNIX files polled by devices
+    int numWatchedFiles;
+
+    bool OnlyPollsPending(void);        // Is every pending interrupt a
+                                        // device poll?
+    void WaitForInput(void);            // Block the host until a watched
+                                        // file is readable
+#endif
 };
 
 #endif // INTERRRUPT_H
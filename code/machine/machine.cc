@@ -64,12 +64,21 @@ Machine::Machine(bool debug)
 #ifdef USE_TLB
     tlb = new TranslationEntry[TLBSize];
     for (i = 0; i < TLBSize; i++)
+      {
         tlb[i].valid = FALSE;
+#ifdef CHANGED
+        tlb[i].superpage = FALSE;
+#endif
+      }
 #else	// use linear page table
     tlb = NULL;
 #endif
     currentPageTable = NULL;
     currentPageTableSize = 0;
+#ifdef CHANGED
+    currentPageDirectory = NULL;
+    linkedAddr = -1;
+#endif
 
     singleStep = debug;
     runUntilTime = 0;
@@ -110,6 +119,9 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
 
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);			// finish anything in progress
+#ifdef CHANGED
+    linkedAddr = -1;			// the kernel may touch the word
+#endif
     interrupt->setStatus(SystemMode);
     ExceptionHandler(which);		// interrupts are enabled at this point
     interrupt->setStatus(oldStatus);
@@ -294,6 +306,10 @@ Machine::DumpPageTable(FILE *output,
 
                 TranslationEntry *save_pageTable = currentPageTable;
                 unsigned save_pageTableSize = currentPageTableSize;
+#ifdef CHANGED
+                TranslationEntry **save_pageDirectory = currentPageDirectory;
+                currentPageDirectory = NULL;
+#endif
 
                 currentPageTable = _pageTable;
                 currentPageTableSize = _pageTableSize;
@@ -306,6 +322,9 @@ Machine::DumpPageTable(FILE *output,
 
                 currentPageTable = save_pageTable;
                 currentPageTableSize = save_pageTableSize;
+#ifdef CHANGED
+                currentPageDirectory = save_pageDirectory;
+#endif
 
                 get_RGB(value, &r, &g, &b);
 
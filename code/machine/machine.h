@@ -35,6 +35,12 @@
 #define NumPhysPages    64              // Increase this as necessary!
 #define MemorySize      (NumPhysPages * PageSize)
 #define TLBSize         4               // if there is a TLB, make it small
+#ifdef CHANGED
+#define SecondLevelPages 32             // pages mapped by one second-level
+                                        // table of a two-level page table
+#define SuperPagePages  4               // pages mapped by one superpage
+                                        // entry; divides SecondLevelPages
+#endif
 
 enum ExceptionType { NoException,           // Everything ok!
                      SyscallException,      // A program executed a system call.
@@ -177,6 +183,11 @@ class Machine:public dontcopythis {
     char *mainMemory;           // physical memory to store user program,
                                 // code and data, while executing
     int registers[NumTotalRegs]; // CPU registers, for executing user programs
+#ifdef CHANGED
+    int linkedAddr;             // address loaded by the last LL, where the
+                                // next SC may store, or -1 once an exception
+                                // or a context switch broke the link
+#endif
 
 
 // NOTE: the hardware translation of virtual addresses in the user program
@@ -202,6 +213,12 @@ class Machine:public dontcopythis {
 
     TranslationEntry *currentPageTable;
     unsigned int currentPageTableSize;
+#ifdef CHANGED
+    TranslationEntry **currentPageDirectory; // two-level page table:
+                                // entry i points to the SecondLevelPages
+                                // entries of pages i*SecondLevelPages...,
+                                // or is NULL if they are all invalid
+#endif
 
   private:
     bool singleStep;            // drop back into the debugger after each
@@ -297,6 +297,22 @@ Machine::OneInstruction(Instruction *instr)
         nextLoadValue = value;
         break;
 
+#ifdef CHANGED
+      case OP_LL:
+        // LW, which also links the address for the next SC
+        tmp = registers[instr->rs] + instr->extra;
+        if (tmp & 0x3) {
+            RaiseException(AddressErrorException, tmp);
+            return;
+        }
+        if (!machine->ReadMem(tmp, 4, &value))
+            return;
+        linkedAddr = tmp;
+        nextLoadReg = instr->rt;
+        nextLoadValue = value;
+        break;
+#endif
+
       case OP_LWR:
         tmp = registers[instr->rs] + instr->extra;
 
@@ -492,6 +508,26 @@ Machine::OneInstruction(Instruction *instr)
             return;
         break;
 
+#ifdef CHANGED
+      case OP_SC:
+        // SW only if nothing broke the link since the LL, and rt tells
+        // whether it did
+        tmp = registers[instr->rs] + instr->extra;
+        if (tmp & 0x3) {
+            RaiseException(AddressErrorException, tmp);
+            return;
+        }
+        if (linkedAddr != tmp) {
+            registers[instr->rt] = 0;
+            break;
+        }
+        if (!machine->WriteMem(tmp, 4, registers[instr->rt]))
+            return;
+        registers[instr->rt] = 1;
+        linkedAddr = -1;
+        break;
+#endif
+
       case OP_SWR:
         tmp = registers[instr->rs] + instr->extra;
 
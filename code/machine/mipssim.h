@@ -85,7 +85,13 @@
 #define OP_SYSCALL	61
 #define OP_UNIMP	62
 #define OP_RES		63
+#ifdef CHANGED
+#define OP_LL		64
+#define OP_SC		65
+#define MaxOpcode	65
+#else
 #define MaxOpcode	63
+#endif
 
 /*
  * Miscellaneous definitions:
@@ -127,9 +133,17 @@ static OpInfo opTable[] = {
     {OP_LBU, IFMT}, {OP_LHU, IFMT}, {OP_LWR, IFMT}, {OP_RES, IFMT},
     {OP_SB, IFMT}, {OP_SH, IFMT}, {OP_SWL, IFMT}, {OP_SW, IFMT},
     {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_SWR, IFMT}, {OP_RES, IFMT},
+#ifdef CHANGED
+    {OP_LL, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT},
+#else
     {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT},
+#endif
     {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT},
+#ifdef CHANGED
+    {OP_SC, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT},
+#else
     {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT},
+#endif
     {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT}
 };
 
@@ -223,7 +237,13 @@ static struct OpString opStrings[] = {
         {"XORI r%d,r%d,%d", {RT, RS, EXTRA}},
         {"SYSCALL", {NONE, NONE, NONE}},
         {"Unimplemented", {NONE, NONE, NONE}},
+#ifdef CHANGED
+        {"Reserved", {NONE, NONE, NONE}},
+        {"LL r%d,%d(r%d)", {RT, EXTRA, RS}},
+        {"SC r%d,%d(r%d)", {RT, EXTRA, RS}}
+#else
         {"Reserved", {NONE, NONE, NONE}}
+#endif
       };
 
 #endif // MIPSSIM_H
@@ -45,10 +45,16 @@ Network::Network(NetworkAddress addr, double reliability,
 
     // start polling for incoming packets
     interrupt->Schedule(NetworkReadPoll, this, NetworkTime, NetworkRecvInt);
+#ifdef CHANGED
+    interrupt->WatchFile(sock);
+#endif
 }
 
 Network::~Network()
 {
+#ifdef CHANGED
+    interrupt->UnwatchFile(sock);
+#endif
     CloseSocket(sock);
     sock = -1;
     DeAssignNameToSocket(sockName);
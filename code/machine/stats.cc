@@ -10,6 +10,9 @@
 #include "copyright.h"
 #include "utility.h"
 #include "stats.h"
+#if defined(USER_PROGRAM) && defined(CHANGED)
+#include "exception.h"
+#endif
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -22,6 +25,32 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+#ifdef CHANGED
+    numZeroPageHits = numZeroPageCopies = 0;
+    numImageLoads = numImageHits = 0;
+    numKsmPasses = numKsmPagesScanned = numKsmBytesCompared = 0;
+    numKsmMerged = numKsmUnmerged = 0;
+    numSwapOuts = numSwapDiskWrites = numSwapDiskWritesAvoided = 0;
+    numZswapStored = numZswapOriginalBytes = numZswapCompressedBytes = 0;
+    numZswapHits = numZswapMisses = numZswapWritebacks = 0;
+    numWorkingSetSamples = maxWorkingSetTotal = 0;
+    numSuspensions = numReadmissions = 0;
+    numPagesPrefetched = numStartupFaults = 0;
+    numMmapPageIns = numMmapWritebacks = 0;
+    numSecondLevelTables = maxPageTableBytes = 0;
+    numTranslations = numSuperpageTranslations = 0;
+    numSuperpageReservations = numSuperpageReservationsBroken = 0;
+    numSuperpagePromotions = numSuperpageDemotions = 0;
+    numConsoleHostWrites = 0;
+    numHostPolls = numHostPollsSkipped = 0;
+    numSyscallTraps = numRingRequests = numBytesCopied = 0;
+    numBadSyscalls = 0;
+    numAioRequests = numAioWaitsBlocked = 0;
+    numPipeBytes = numPipeWaits = 0;
+    numFutexWaits = numFutexWakes = 0;
+    numUserThreads = 0;
+    numHeapPages = numHeapPagesFreed = 0;
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -44,6 +73,53 @@ Statistics::Print()
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead,
         numConsoleCharsWritten);
     printf("Paging: faults %d\n", numPageFaults);
+#ifdef CHANGED
+    printf("Zero page: hits %d, copies on write %d\n", numZeroPageHits,
+        numZeroPageCopies);
+    printf("Text images: loaded %d, shared %d\n", numImageLoads,
+        numImageHits);
+    printf("Page merging: passes %d, pages scanned %d, bytes compared %d, "
+        "merged %d, unmerged %d\n", numKsmPasses, numKsmPagesScanned,
+        numKsmBytesCompared, numKsmMerged, numKsmUnmerged);
+    printf("Swap: pages out %d, disk writes %d, disk writes avoided %d\n",
+        numSwapOuts, numSwapDiskWrites, numSwapDiskWritesAvoided);
+    printf("Compressed pool: stored %d, compression ratio %.2f, "
+        "hit rate %.2f, written back %d\n", numZswapStored,
+        numZswapCompressedBytes ? (double) numZswapOriginalBytes
+                                  / numZswapCompressedBytes : 0.0,
+        numZswapHits + numZswapMisses ? (double) numZswapHits
+                                        / (numZswapHits + numZswapMisses) : 0.0,
+        numZswapWritebacks);
+    printf("Load control: samples %d, peak working sets %d pages, "
+        "suspensions %d, readmissions %d\n", numWorkingSetSamples,
+        maxWorkingSetTotal, numSuspensions, numReadmissions);
+    printf("Startup prefetch: pages prefetched %d, startup faults %d\n",
+        numPagesPrefetched, numStartupFaults);
+    printf("Mapped files: pages read in %d, written back %d\n",
+        numMmapPageIns, numMmapWritebacks);
+    printf("Page tables: second-level tables %d, largest %d bytes\n",
+        numSecondLevelTables, maxPageTableBytes);
+    printf("Superpages: runs reserved %d, frames taken back %d, promoted %d, "
+        "demoted %d, translations %d of %d\n", numSuperpageReservations,
+        numSuperpageReservationsBroken, numSuperpagePromotions,
+        numSuperpageDemotions, numSuperpageTranslations, numTranslations);
+    printf("Console output: host writes %d\n", numConsoleHostWrites);
+    printf("System calls: traps %d, ring requests %d, bytes copied %d, "
+        "unknown %d\n", numSyscallTraps, numRingRequests, numBytesCopied,
+        numBadSyscalls);
+#ifdef USER_PROGRAM
+    PrintSyscallStats();
+#endif
+    printf("Asynchronous I/O: requests %d, waits blocked %d\n",
+        numAioRequests, numAioWaitsBlocked);
+    printf("Pipes: bytes %d, waits %d\n", numPipeBytes, numPipeWaits);
+    printf("Futexes: waits %d, wakes %d\n", numFutexWaits, numFutexWakes);
+    printf("User threads: created %d\n", numUserThreads);
+    printf("Heap: pages backed %d, given back %d\n", numHeapPages,
+           numHeapPagesFreed);
+    printf("Device polls: host checks %d, skipped %d\n", numHostPolls,
+        numHostPollsSkipped);
+#endif
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd,
         numPacketsSent);
 }
@@ -45,6 +45,63 @@ class Statistics {
     int numPageFaults;          // number of virtual memory page faults
     int numPacketsSent;         // number of packets sent over the network
     int numPacketsRecvd;        // number of packets received over the network
+#ifdef CHANGED
+    int numZeroPageHits;        // number of pages mapped to the shared zero frame
+    int numZeroPageCopies;      // number of zero pages copied on first write
+    int numImageLoads;          // number of text images loaded from executables
+    int numImageHits;           // number of address spaces sharing a cached image
+    int numKsmPasses;           // number of same-page merging passes over memory
+    int numKsmPagesScanned;     // number of pages hashed by same-page merging
+    int numKsmBytesCompared;    // number of bytes compared by same-page merging
+    int numKsmMerged;           // number of pages merged with an identical one
+    int numKsmUnmerged;         // number of merged pages copied on write
+    int numSwapOuts;            // number of pages evicted
+    int numSwapDiskWrites;      // number of pages written to the swap disk
+    int numSwapDiskWritesAvoided; // number of pages evicted to the compressed
+                                // pool which never reached the disk
+    int numZswapStored;         // number of pages stored in the compressed pool
+    int numZswapOriginalBytes;  // their total size
+    int numZswapCompressedBytes; // their total size once compressed
+    int numZswapHits;           // number of pages swapped in from the pool
+    int numZswapMisses;         // number of pages swapped in from the disk
+    int numZswapWritebacks;     // number of pages moved from the pool to disk
+    int numWorkingSetSamples;   // number of working set samples
+    int maxWorkingSetTotal;     // largest sum of active working sets, in pages
+    int numSuspensions;         // number of processes suspended by load control
+    int numReadmissions;        // number of processes readmitted
+    int numPagesPrefetched;     // number of startup pages backed in advance
+    int numStartupFaults;       // number of first-touch faults while starting
+    int numMmapPageIns;         // number of mapped file pages read in
+    int numMmapWritebacks;      // number of mapped file pages written back
+    int numSecondLevelTables;   // number of second-level page tables allocated
+    int maxPageTableBytes;      // largest page table of a process, in bytes
+    int numTranslations;        // number of page table or TLB translations
+    int numSuperpageTranslations; // those done by a superpage entry
+    int numSuperpageReservations; // number of frame runs reserved
+    int numSuperpageReservationsBroken; // number of reserved frames taken
+                                // back for other allocations
+    int numSuperpagePromotions; // number of runs promoted to superpages
+    int numSuperpageDemotions;  // number of superpages split back
+    int numConsoleHostWrites;   // number of UNIX writes of console output
+    int numSyscallTraps;        // number of system call exceptions
+    int numRingRequests;        // number of system calls run from a ring
+    int numBadSyscalls;         // number of unknown system calls
+    int numBytesCopied;         // number of bytes copied from or to user
+                                // memory by system calls
+    int numAioRequests;         // number of asynchronous file requests
+    int numAioWaitsBlocked;     // number of AioWaits which had to block
+    int numPipeBytes;           // number of bytes written to pipes
+    int numPipeWaits;           // number of pipe reads and writes which
+                                // had to block
+    int numFutexWaits;          // number of threads put to sleep by Futex
+    int numFutexWakes;          // number of threads woken by Futex
+    int numUserThreads;         // number of threads started by ThreadCreate
+    int numHeapPages;           // number of heap pages backed on a fault
+    int numHeapPagesFreed;      // number of heap pages given back by Sbrk
+    int numHostPolls;           // number of device polls asking the host
+    int numHostPollsSkipped;    // number of device polls answered without
+                                // asking, as no input was signalled
+#endif
 
     Statistics(void);           // initialize everything to zero
 
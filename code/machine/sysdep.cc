@@ -94,6 +94,98 @@ int sendto (int, const void*, int, int, void*, int);
 #include "interrupt.h"
 #include "system.h"
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// Asynchronous input
+//	The files polled by the console and the network are switched to
+//	O_ASYNC, so that the host sends us SIGIO when input arrives.  A
+//	poll then only has to ask the host when there was a SIGIO since the
+//	file was last found empty.  Regular files never send SIGIO, so
+//	they are always asked.
+//----------------------------------------------------------------------
+
+struct AsyncFile {
+    int fd;
+    int oldFlags;               // file status flags to put back
+    bool alwaysReady;           // cannot signal, always ask the host
+    volatile sig_atomic_t maybeReady; // SIGIO since last found empty
+};
+
+static AsyncFile asyncFiles[MaxWatchedFiles];
+static int numAsyncFiles;
+
+static void
+SigioHandler(int sig)
+{
+    (void) sig;
+    for (int i = 0; i < numAsyncFiles; i++)
+        asyncFiles[i].maybeReady = 1;   // we cannot tell which one
+}
+
+static AsyncFile *
+FindAsyncFile(int fd)
+{
+    for (int i = 0; i < numAsyncFiles; i++)
+        if (asyncFiles[i].fd == fd)
+            return &asyncFiles[i];
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// StartAsyncInput
+//	Have the host send SIGIO when "fd" becomes readable.
+//----------------------------------------------------------------------
+
+void
+StartAsyncInput(int fd)
+{
+    struct stat st;
+    AsyncFile *async;
+
+    ASSERT(numAsyncFiles < MaxWatchedFiles);
+    if (numAsyncFiles == 0) {
+        // Before any O_ASYNC: the default action of SIGIO ends us
+        struct sigaction action;
+
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = SigioHandler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        (void) sigaction(SIGIO, &action, NULL);
+    }
+
+    async = &asyncFiles[numAsyncFiles];
+    async->fd = fd;
+    async->oldFlags = fcntl(fd, F_GETFL);
+    async->maybeReady = 1;              // whatever came before we started
+    numAsyncFiles++;                    // seen by the handler from now on
+
+    async->alwaysReady = fstat(fd, &st) < 0 || S_ISREG(st.st_mode)
+        || async->oldFlags < 0
+        || fcntl(fd, F_SETOWN, getpid()) < 0
+        || fcntl(fd, F_SETFL, async->oldFlags | O_ASYNC) < 0;
+}
+
+//----------------------------------------------------------------------
+// StopAsyncInput
+//	Put "fd" back the way StartAsyncInput found it.
+//----------------------------------------------------------------------
+
+void
+StopAsyncInput(int fd)
+{
+    AsyncFile *async = FindAsyncFile(fd);
+
+    if (async == NULL)
+        return;
+    if (!async->alwaysReady)
+        (void) fcntl(fd, F_SETFL, async->oldFlags);
+    *async = asyncFiles[--numAsyncFiles];
+    if (numAsyncFiles == 0)
+        (void) signal(SIGIO, SIG_DFL);
+}
+#endif
+
 //----------------------------------------------------------------------
 // PollFile
 //	Check open file or open socket to see if there are any
@@ -122,10 +214,27 @@ PollFile(int fd)
 #endif
     struct timeval pollTime;
 
+#ifdef CHANGED
+    AsyncFile *async = FindAsyncFile(fd);
+
+    if (async != NULL && !async->alwaysReady) {
+        if (!async->maybeReady) {
+            stats->numHostPollsSkipped++;
+            return FALSE;               // no SIGIO since it was found empty
+        }
+        async->maybeReady = 0;          // until SIGIO, or the select below
+    }
+    stats->numHostPolls++;
+#endif
+
 // decide how long to wait if there are no characters on the file
     pollTime.tv_sec = 0;
     if (interrupt->getStatus() == IdleMode)
+#ifdef CHANGED
+        pollTime.tv_usec = IdlePollUsecs;   // delay to let other nachos run
+#else
         pollTime.tv_usec = 20000;           // delay to let other nachos run
+#endif
     else
         pollTime.tv_usec = 0;               // no delay
 
@@ -138,12 +247,55 @@ PollFile(int fd)
     retVal = select(32, &rfd, &wfd, &xfd, &pollTime);
 #endif
 
+#ifdef CHANGED
+    if (retVal < 0 && errno == EINTR)
+        retVal = 0;                         // SIGIO, maybeReady is set again
+    if (retVal == 1 && async != NULL)
+        async->maybeReady = 1;              // more may follow this character
+#endif
     ASSERT((retVal == 0) || (retVal == 1));
     if (retVal == 0)
         return FALSE;                       // no char waiting to be read
     return TRUE;
 }
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// WaitForFiles
+//	Wait until one of the open files or sockets "fds" has characters to
+//	be read, or for "timeout" microseconds.  Return how long we waited,
+//	in microseconds.
+//
+//	"fds" -- the file descriptors to wait on
+//	"numFds" -- how many there are
+//	"timeout" -- the longest wait
+//----------------------------------------------------------------------
+
+long long
+WaitForFiles(const int *fds, int numFds, int timeout)
+{
+    fd_set rfd;
+    int maxFd = -1;
+    struct timeval waitTime, before, after;
+
+    FD_ZERO(&rfd);
+    for (int i = 0; i < numFds; i++) {
+        FD_SET(fds[i], &rfd);
+        if (fds[i] > maxFd)
+            maxFd = fds[i];
+    }
+    waitTime.tv_sec = timeout / 1000000;
+    waitTime.tv_usec = timeout % 1000000;
+
+    gettimeofday(&before, NULL);
+    (void) select(maxFd + 1, &rfd, NULL, NULL, &waitTime); // EINTR is fine
+    gettimeofday(&after, NULL);
+
+    return (after.tv_sec - before.tv_sec) * 1000000LL
+           + (after.tv_usec - before.tv_usec);
+}
+#endif
+
 //----------------------------------------------------------------------
 // OpenForWrite
 //	Open a file for writing.  Create it if it doesn't exist; truncate it
@@ -245,6 +397,23 @@ Tell(int fd)
 #endif
 }
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// FileId
+//	Return a number identifying the file behind "fd" (its inode),
+//	the same for every open of the same file.
+//----------------------------------------------------------------------
+
+int
+FileId(int fd)
+{
+    struct stat st;
+    int retVal = fstat(fd, &st);
+    ASSERT(retVal == 0);
+    return (int) st.st_ino;
+}
+#endif
+
 
 //----------------------------------------------------------------------
 // Close
@@ -553,26 +722,150 @@ DeallocBoundedArray(char *ptr, int size)
     #ifdef USER_PROGRAM				
 
     //----------------------------------------------------------------------
-    //  copyStringFromMachine
-    //	Copy size bytes from a MIPS memory address to a char* in user-space
+    //  translateUser
+    //	Translate the user address "virtAddr" of the current address
+    //	space, backing its page first if needed (swap-in, mapped file,
+    //	stack growth, copy-on-write).  The whole page from there on can
+    //	then be reached in mainMemory.
+    //
+    //	Return the physical address, or -1 if "virtAddr" is bad.
+    //
+    //	"writing" -- whether the kernel is about to write the page
+    //----------------------------------------------------------------------
+
+    static int translateUser(int virtAddr, bool writing) {
+        int physAddr;
+        ExceptionType exception;
+
+        while ((exception = machine->Translate(virtAddr, &physAddr, 1,
+                                               writing, FALSE)) != NoException) {
+            if (!currentThread->space->ResolveFault(exception, virtAddr,
+                                                    machine->ReadRegister(StackReg)))
+                return -1;
+        }
+        return physAddr;
+    }
+
+    //----------------------------------------------------------------------
+    //  copyIn
+    //	Copy "size" bytes from user address "from" to the kernel buffer
+    //	"to", translating each page once.
+    //
+    //	Return FALSE if part of the range is not a valid user address.
+    //----------------------------------------------------------------------
+
+    bool copyIn(int from, void *to, unsigned size) {
+        char *dst = (char *) to;
+
+        while (size > 0) {
+            int physAddr = translateUser(from, FALSE);
+            if (physAddr < 0)
+                return FALSE;
+
+            unsigned span = PageSize - (unsigned) from % PageSize;
+            if (span > size)
+                span = size;
+            memcpy(dst, &machine->mainMemory[physAddr], span);
+            stats->numBytesCopied += span;
+            from += span;
+            dst += span;
+            size -= span;
+        }
+        return TRUE;
+    }
+
+    //----------------------------------------------------------------------
+    //  copyOut
+    //	Copy "size" bytes from the kernel buffer "from" to user address
+    //	"to", translating each page once.
+    //
+    //	Return FALSE if part of the range is not a valid, writable user
+    //	address.  The pages before it have been written already.
+    //----------------------------------------------------------------------
+
+    bool copyOut(const void *from, int to, unsigned size) {
+        const char *src = (const char *) from;
+
+        while (size > 0) {
+            int physAddr = translateUser(to, TRUE);
+            if (physAddr < 0)
+                return FALSE;
+
+            unsigned span = PageSize - (unsigned) to % PageSize;
+            if (span > size)
+                span = size;
+            memcpy(&machine->mainMemory[physAddr], src, span);
+            stats->numBytesCopied += span;
+            to += span;
+            src += span;
+            size -= span;
+        }
+        return TRUE;
+    }
+
+    //----------------------------------------------------------------------
+    //  copyInString
+    //	Copy the string at user address "from" to the kernel buffer "to",
+    //	at most "size"-1 characters, and terminate it with a '\0'.
     //
-    //	"from" -- initial address to copy in MIPS-space
-    //	"to" -- string in user-space to which the value is copied to
-    //  "size" -- number of bytes (characters) of the string 
+    //	Return the number of characters copied, or -1 if the string runs
+    //	into an invalid user address.
     //----------------------------------------------------------------------
 
-    unsigned copyStringFromMachine(int from, char *to, unsigned size) {
-        unsigned c_read = 0;
-        char* to_copy = to;
-        int c_machine;
-        for(unsigned i = 0; i < size-1; i++) {
-            machine->ReadMem(from+i, 1, &c_machine);
-            if(c_machine == '\0') break;
-            *(to_copy++) = (char) c_machine;
-            c_read++;
+    int copyInString(int from, char *to, unsigned size) {
+        unsigned copied = 0;
+
+        ASSERT(size > 0);
+        while (copied < size - 1) {
+            int physAddr = translateUser(from + copied, FALSE);
+            if (physAddr < 0)
+                return -1;
+
+            unsigned span = PageSize - (unsigned) (from + copied) % PageSize;
+            if (span > size - 1 - copied)
+                span = size - 1 - copied;
+            const char *src = &machine->mainMemory[physAddr];
+            const char *end = (const char *) memchr(src, '\0', span);
+            if (end != NULL)
+                span = end - src;
+            memcpy(to + copied, src, span);
+            stats->numBytesCopied += span;
+            copied += span;
+            if (end != NULL)
+                break;
         }
-        *to_copy = '\0';
-        return c_read;
+        to[copied] = '\0';
+        return copied;
+    }
+
+    //----------------------------------------------------------------------
+    //  userSpan
+    //	Return where user address "virtAddr" is in mainMemory, backing its
+    //	page first if needed, and in "span" how many of the next "size"
+    //	bytes follow it there.  The span goes on over the next pages as
+    //	long as they are already backed by the next frames.
+    //
+    //	Return NULL if "virtAddr" is bad.
+    //
+    //	"writing" -- whether the kernel is about to write the span
+    //----------------------------------------------------------------------
+
+    char *userSpan(int virtAddr, unsigned size, bool writing, unsigned *span) {
+        int physAddr = translateUser(virtAddr, writing);
+        int nextAddr;
+
+        if (physAddr < 0)
+            return NULL;
+
+        *span = PageSize - (unsigned) virtAddr % PageSize;
+        while (*span < size
+               && machine->Translate(virtAddr + *span, &nextAddr, 1, writing,
+                                     FALSE) == NoException
+               && nextAddr == physAddr + (int) *span)
+            *span += PageSize;
+        if (*span > size)
+            *span = size;
+        return &machine->mainMemory[physAddr];
     }
 
     #endif
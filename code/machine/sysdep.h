@@ -17,6 +17,20 @@
 // If no characters in the file, return without waiting.
 extern bool PollFile(int fd);
 
+#ifdef CHANGED
+#define IdlePollUsecs	20000	// how long PollFile waits when the machine
+				// is idle, to let other nachos run
+
+// Wait until one of the files has characters to be read, or for "timeout"
+// microseconds, and return how long that took.
+extern long long WaitForFiles(const int *fds, int numFds, int timeout);
+
+// Have the host signal when "fd" has characters to be read, so that
+// PollFile only asks it then.
+extern void StartAsyncInput(int fd);
+extern void StopAsyncInput(int fd);
+#endif
+
 // File operations: open/read/write/lseek/close, and check for error
 // For simulating the disk and the console devices.
 extern int OpenForWrite(const char *name);
@@ -26,6 +40,9 @@ extern int ReadPartial(int fd, void *buffer, int nBytes);
 extern void WriteFile(int fd, const void *buffer, int nBytes);
 extern void Lseek(int fd, int offset, int whence);
 extern int Tell(int fd);
+#ifdef CHANGED
+extern int FileId(int fd);
+#endif
 extern void Close(int fd);
 extern bool Unlink(const char *name);
 
@@ -59,7 +76,11 @@ extern void DeallocBoundedArray(char *p, int size);
 
 #ifdef USER_PROGRAM	
     #ifdef CHANGED
-        extern unsigned copyStringFromMachine(int from, char *to, unsigned size);
+        extern bool copyIn(int from, void *to, unsigned size);
+        extern bool copyOut(const void *from, int to, unsigned size);
+        extern int copyInString(int from, char *to, unsigned size);
+        extern char *userSpan(int virtAddr, unsigned size, bool writing,
+                              unsigned *span);
     #endif
 #endif
 
@@ -208,8 +208,15 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing, bool deb
     }
 
     // we must have either a TLB or a page table, but not both!
+#ifdef CHANGED
+    ASSERT_MSG(tlb == NULL || (currentPageTable == NULL && currentPageDirectory == NULL),
+               "We have both a TLB and a page table!\n");
+    ASSERT_MSG(tlb != NULL || currentPageTable != NULL || currentPageDirectory != NULL,
+               "We don't have a TLB nor a page table!\n");
+#else
     ASSERT_MSG(tlb == NULL || currentPageTable == NULL, "We don't have a TLB nor a page table!\n");
     ASSERT_MSG(tlb != NULL || currentPageTable != NULL, "We have both a TLB and a page table!\n");
+#endif
 
 // calculate the virtual page number, and offset within the page,
 // from the virtual address
@@ -221,15 +228,40 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing, bool deb
             if (debug) DEBUG('a', "virtual page # %d too large for page table size %d!\n",
                         virtAddr, currentPageTableSize);
             return AddressErrorException;
+#ifdef CHANGED
+        } else if (currentPageDirectory != NULL) {
+            // two-level page table
+            TranslationEntry *second = currentPageDirectory[vpn / SecondLevelPages];
+            if (second == NULL || !second[vpn % SecondLevelPages].valid) {
+                if (debug) DEBUG('a', "virtual page # %d : page %d is invalid !\n",
+                            virtAddr, vpn);
+                return PageFaultException;
+            }
+            entry = &second[vpn % SecondLevelPages];
+#endif
         } else if (!currentPageTable[vpn].valid) {
             if (debug) DEBUG('a', "virtual page # %d : page %d is invalid !\n",
                         virtAddr, vpn);
             return PageFaultException;
         }
+#ifdef CHANGED
+        if (currentPageDirectory == NULL)
+#endif
         entry = &currentPageTable[vpn];
+#ifdef CHANGED
+        // the first entry of a superpage translates all of its pages
+        if (entry[- (int) (vpn % SuperPagePages)].superpage)
+            entry -= vpn % SuperPagePages;
+#endif
     } else {
         for (entry = NULL, i = 0; i < TLBSize; i++)
+#ifdef CHANGED
+            if (tlb[i].valid && (tlb[i].virtualPage == vpn
+                                 || (tlb[i].superpage
+                                     && tlb[i].virtualPage == vpn - vpn % SuperPagePages))) {
+#else
             if (tlb[i].valid && (tlb[i].virtualPage == vpn)) {
+#endif
                 entry = &tlb[i];                        // FOUND!
                 break;
             }
@@ -250,6 +282,13 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing, bool deb
         return ReadOnlyException;
     }
     pageFrame = entry->physicalPage;
+#ifdef CHANGED
+    stats->numTranslations++;
+    if (entry->superpage) {
+        pageFrame += vpn % SuperPagePages;
+        stats->numSuperpageTranslations++;
+    }
+#endif
 
     // if the pageFrame is too big, there is something really wrong!
     // An invalid translation was loaded into the page table or TLB.
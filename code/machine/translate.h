@@ -41,6 +41,13 @@ class TranslationEntry {
                         // page is referenced or modified.
     bool dirty;         // This bit is set by the hardware every time the
                         // page is modified.
+#ifdef CHANGED
+    bool superpage;     // If this bit is set, the entry translates the
+                        // SuperPagePages pages from virtualPage on (a
+                        // multiple of SuperPagePages) to as many frames
+                        // from physicalPage on.  Only the use and dirty
+                        // bits of this entry are updated for all of them.
+#endif
 };
 
 #endif
@@ -0,0 +1,110 @@
+/* aio.c
+ *	Test program for asynchronous file I/O.
+ *
+ *	Queues several writes at odd offsets of a file and polls their
+ *	status words until they are done, then reads them back with
+ *	AioWait.  Last, it runs itself again as a child, marked by
+ *	"aio.mark", which queues more writes and exits without waiting:
+ *	the kernel must finish them first.  Run from the userprog
+ *	directory.
+ */
+
+#include "syscall.h"
+
+#define NREQ 4
+#define CHUNK 300
+#define OFFSET 7
+#define TAIL (OFFSET + NREQ * CHUNK)	/* where the child writes */
+#define TAIL_CHUNK 100
+
+AioControl controls[NREQ];
+char out[NREQ * CHUNK], in[NREQ * CHUNK];
+
+void
+Submit (OpenFileId id, char *buffer, int size, int offset, int n,
+        int reading)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+      {
+          controls[i].id = id;
+          controls[i].buffer = buffer + i * size;
+          controls[i].size = size;
+          controls[i].offset = offset + i * size;
+          if ((reading ? AioRead (&controls[i]) : AioWrite (&controls[i]))
+              != 0)
+              Exit (1);
+      }
+}
+
+int
+main ()
+{
+    OpenFileId id, mark;
+    char c = 0;
+    int i, pending;
+
+    mark = Open ("aio.mark");
+    if (mark >= 0)
+      {
+          Read (&c, 1, mark);
+          Close (mark);
+      }
+    if (c == 'c')
+      {
+          /* The child: leave the writes for Exit to finish */
+          Create ("aio.mark");
+          for (i = 0; i < NREQ * TAIL_CHUNK; i++)
+              out[i] = 'A' + i % 26;
+          id = Open ("aio.txt");
+          Submit (id, out, TAIL_CHUNK, TAIL, NREQ, 0);
+          Exit (0);
+      }
+
+    if (Create ("aio.txt") != 0 || (id = Open ("aio.txt")) < 0)
+        Exit (2);
+    for (i = 0; i < NREQ * CHUNK; i++)
+        out[i] = 'a' + i % 26;
+
+    Submit (id, out, CHUNK, OFFSET, NREQ, 0);
+    do
+      {
+          pending = 0;
+          for (i = 0; i < NREQ; i++)
+              if (controls[i].status == AIO_PENDING)
+                  pending++;
+              else if (controls[i].status != CHUNK)
+                  Exit (3);
+          if (pending > 0)
+              Yield ();
+      }
+    while (pending > 0);
+
+    Submit (id, in, CHUNK, OFFSET, NREQ, 1);
+    for (i = 0; i < NREQ; i++)
+        if (AioWait (&controls[i]) != CHUNK)
+            Exit (4);
+    for (i = 0; i < NREQ * CHUNK; i++)
+        if (in[i] != out[i])
+            Exit (5);
+
+    Create ("aio.mark");
+    mark = Open ("aio.mark");
+    c = 'c';
+    Write (&c, 1, mark);
+    Close (mark);
+    if (Join (Exec ("../test/aio")) != 0)
+        Exit (6);
+
+    Submit (id, in, TAIL_CHUNK, TAIL, NREQ, 1);
+    for (i = 0; i < NREQ; i++)
+        if (AioWait (&controls[i]) != TAIL_CHUNK)
+            Exit (7);
+    for (i = 0; i < NREQ * TAIL_CHUNK; i++)
+        if (in[i] != 'A' + i % 26)
+            Exit (8);
+    Close (id);
+    PutString ("aio done\n");
+    Exit (0);
+}
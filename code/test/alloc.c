@@ -0,0 +1,84 @@
+/* alloc.c
+ *	Test program for the heap: Sbrk and the allocator of the user
+ *	runtime.
+ *
+ *	Several threads keep a table of blocks of random sizes, freeing
+ *	and allocating them over and over, and check that no block was
+ *	overwritten by another one.  A few blocks are too big for the
+ *	slabs.  Run with -rs to get them preempted in the middle of it.
+ */
+
+#include "syscall.h"
+
+#define NTHREADS 3
+#define NBLOCKS 40
+#define ROUNDS 400
+
+int
+worker (void *arg)
+{
+    char *blocks[NBLOCKS];
+    int sizes[NBLOCKS];
+    unsigned int seed = (unsigned int) arg + 1;
+    int i, k, round;
+
+    for (i = 0; i < NBLOCKS; i++)
+        blocks[i] = 0;
+
+    for (round = 0; round < ROUNDS; round++)
+      {
+          seed = seed * 1103515245 + 12345;
+          i = (seed >> 8) % NBLOCKS;
+          if (blocks[i] != 0)
+            {
+                for (k = 0; k < sizes[i]; k++)
+                    if (blocks[i][k] != (char) (i + k))
+                        return -1;
+                free (blocks[i]);
+                blocks[i] = 0;
+            }
+          else
+            {
+                sizes[i] = (seed >> 16) % ((seed & 0xf) == 0 ? 1500 : 100);
+                blocks[i] = malloc (sizes[i]);
+                if (blocks[i] == 0)
+                    return -2;
+                for (k = 0; k < sizes[i]; k++)
+                    blocks[i][k] = i + k;
+            }
+      }
+
+    for (i = 0; i < NBLOCKS; i++)
+        free (blocks[i]);
+    return (int) arg;
+}
+
+int
+main ()
+{
+    int ids[NTHREADS];
+    int *zeros;
+    int i;
+
+    for (i = 0; i < NTHREADS; i++)
+      {
+          ids[i] = ThreadCreate (worker, (void *) i);
+          if (ids[i] < 0)
+              Exit (1);
+      }
+    for (i = 0; i < NTHREADS; i++)
+        if (ThreadJoin (ids[i]) != i)
+            Exit (2);
+
+    zeros = calloc (100, sizeof (int));
+    zeros = realloc (zeros, 2000);
+    if (zeros == 0)
+        Exit (3);
+    for (i = 0; i < 100; i++)
+        if (zeros[i] != 0)
+            Exit (4);
+    free (zeros);
+
+    PutString ("alloc done\n");
+    Exit (0);
+}
@@ -0,0 +1,28 @@
+/* exectext.c
+ *	Test program for Exec, Join, and shared text pages.
+ *
+ *	Starts the same executable twice: the second process maps the
+ *	code pages loaded for the first one (see the "Text images" line
+ *	of the statistics).  Run from the userprog directory.
+ */
+
+#include "syscall.h"
+
+int
+main ()
+{
+    SpaceId first, second;
+
+    first = Exec ("../test/zeropage");
+    second = Exec ("../test/zeropage");
+    if (first < 0 || second < 0)
+        Exit (1);
+
+    if (Join (first) != 0 || Join (second) != 0)
+        Exit (2);
+    if (Join (first) != -1)
+        Exit (3);
+
+    PutString ("both done\n");
+    Exit (0);
+}
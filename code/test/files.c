@@ -0,0 +1,59 @@
+/* files.c
+ *	Test program for the file system calls.
+ *
+ *	Writes a file of several sectors in pieces of odd sizes, so that
+ *	they start and end in the middle of sectors, then reads it back
+ *	in pieces of other odd sizes, and checks every byte.
+ */
+
+#include "syscall.h"
+
+#define SIZE 1000
+
+char buffer[SIZE];
+
+int
+main ()
+{
+    OpenFileId id;
+    int i, done, chunk, n;
+
+    if (Create ("files.txt") != 0)
+        Exit (1);
+    id = Open ("files.txt");
+    if (id < 0)
+        Exit (2);
+
+    for (i = 0; i < SIZE; i++)
+        buffer[i] = 'a' + i % 26;
+    for (done = 0, chunk = 37; done < SIZE; done += chunk, chunk += 50)
+      {
+          if (chunk > SIZE - done)
+              chunk = SIZE - done;
+          Write (buffer + done, chunk, id);
+      }
+    if (Close (id) != 0 || Close (id) != -1)
+        Exit (3);
+
+    for (i = 0; i < SIZE; i++)
+        buffer[i] = 0;
+    id = Open ("files.txt");
+    if (id < 0)
+        Exit (4);
+    for (done = 0, chunk = 131; done < SIZE; done += n)
+      {
+          n = Read (buffer + done, chunk, id);
+          if (n <= 0)
+              Exit (5);
+          chunk = 29 + chunk * 7 % 150;
+      }
+    if (Read (buffer, 1, id) != 0)
+        Exit (6);
+    Close (id);
+
+    for (i = 0; i < SIZE; i++)
+        if (buffer[i] != 'a' + i % 26)
+            Exit (7);
+    PutString ("files done\n");
+    Exit (0);
+}
@@ -0,0 +1,90 @@
+/* futex.c
+ *	Test program for the atomic operations, futexes, and the Mutex
+ *	and Sem built on them.
+ *
+ *	Two processes share a page, mapped MAP_SHARED from a file.  Each
+ *	adds 1000 to a counter with AtomicAdd, and 1000 to another one
+ *	under a Mutex.  The child runs the same program: it finds the
+ *	page already marked by the parent.  It posts a Sem when done,
+ *	which the parent waits for before checking both counters.  Run
+ *	with -rs to get them preempted in the middle of an update, and
+ *	from the userprog directory.
+ */
+
+#include "syscall.h"
+
+#define ROUNDS 1000
+
+typedef struct {
+    int role;			/* 1 once the parent started the child */
+    int atomic;
+    int locked;
+    Mutex lock;
+    Sem done;
+} Shared;
+
+char zeros[128];
+
+void
+Count (Shared *shared)
+{
+    int i;
+
+    for (i = 0; i < ROUNDS; i++)
+      {
+          AtomicAdd (&shared->atomic, 1);
+          MutexLock (&shared->lock);
+          shared->locked = shared->locked + 1;
+          MutexUnlock (&shared->lock);
+      }
+}
+
+int
+main ()
+{
+    Shared *shared;
+    OpenFileId id;
+    SpaceId child;
+
+    id = Open ("futex.shm");
+    if (id < 0)
+      {
+          /* First run: make the file to be shared */
+          if (Create ("futex.shm") != 0 || (id = Open ("futex.shm")) < 0)
+              Exit (1);
+          Write (zeros, sizeof zeros, id);
+      }
+    shared = Mmap (id, 0, sizeof zeros, MAP_SHARED);
+    Close (id);
+    if (shared == 0)
+        Exit (2);
+
+    if (CompareAndSwap (&shared->role, 1, 2) == 1)
+      {
+          /* The child */
+          Count (shared);
+          SemV (&shared->done);
+          Exit (0);
+      }
+
+    shared->atomic = shared->locked = 0;
+    MutexInit (&shared->lock);
+    SemInit (&shared->done, 0);
+    if (Futex (&shared->role, FUTEX_WAIT, 1) != -1)
+        Exit (3);               /* it holds 0, not 1 */
+    shared->role = 1;
+    child = Exec ("../test/futex");
+    if (child < 0)
+        Exit (4);
+
+    Count (shared);
+    SemP (&shared->done);
+    if (shared->atomic != 2 * ROUNDS || shared->locked != 2 * ROUNDS)
+        Exit (5);
+    if (Join (child) != 0)
+        Exit (6);
+    shared->role = 0;
+    Munmap (shared);
+    PutString ("futex done\n");
+    Exit (0);
+}
@@ -0,0 +1,64 @@
+/* info.c
+ *	Test program for the kernel info page: GetTicks, GetUserTicks and
+ *	GetPid.
+ *
+ *	Checks that the tick counters move on while it runs, without a
+ *	system call.  It then runs itself again as a child, which exits
+ *	with the id read from the page: that must be what Exec returned.
+ *	The child first runs a grandchild that stores to the page, which
+ *	is read-only: only the grandchild must end, and its Join gets -1.
+ *	The copies tell themselves apart by the number of processes.
+ *	Exits with 0 after "info done".  Run from the userprog directory.
+ */
+
+#include "syscall.h"
+
+#define LOOPS 1000
+
+int
+main ()
+{
+    unsigned int ticks, userTicks;
+    volatile int spin;
+    SpaceId child;
+    int pid;
+
+    switch (KernelInfoPtr->processes)
+      {
+      case 1:
+          break;
+      case 2:
+          /* The child */
+          child = Exec ("../test/info");
+          if (child < 0 || Join (child) != -1)
+              Exit (-2);
+          Exit (GetPid ());
+      default:
+          /* The grandchild */
+          *(int *) KERNEL_INFO_ADDR = 0;
+          Exit (7);             /* the store must not come back */
+      }
+
+    ticks = GetTicks ();
+    userTicks = GetUserTicks ();
+    for (spin = 0; spin < LOOPS; spin++)
+        ;
+    if (GetTicks () - ticks < LOOPS || GetUserTicks () - userTicks < LOOPS)
+        Exit (1);
+    if (GetUserTicks () > GetTicks ())
+        Exit (2);
+
+    pid = GetPid ();
+    if (pid < 0)
+        Exit (3);
+    child = Exec ("../test/info");
+    if (child < 0 || child == pid)
+        Exit (4);
+    if (Join (child) != child)
+        Exit (5);
+    if (GetPid () != pid)
+        Exit (6);
+
+    PutString ("info done\n");
+    Exit (0);
+}
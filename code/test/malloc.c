@@ -0,0 +1,295 @@
+/* malloc.c
+ *	Heap allocator of the user runtime, on top of Sbrk.  It is built
+ *	into runtime.a, and linked into the programs which use it.
+ *
+ *	Blocks of up to MAX_SMALL bytes come from slabs: SLAB_SIZE-aligned
+ *	chunks of the heap, cut into blocks of a single size class, with
+ *	the class in a header at the start of the slab, so that free finds
+ *	it from the address alone.  A larger block takes a run of whole
+ *	slabs of its own, which goes to a list of free runs when freed,
+ *	or back to the kernel if it is at the end of the heap.  The break
+ *	is only moved from here, so the program must not call Sbrk itself.
+ *
+ *	Each thread keeps a cache of free blocks of each class, which it
+ *	uses without any lock.  It finds it with its stack slot, which
+ *	the kernel keeps in $k1 (see ThreadCreate).  A cache trades BATCH
+ *	blocks at a time with the shared free lists, under a Mutex, when
+ *	it runs empty or grows too big.  A thread started on the slot of
+ *	a thread which exited gets the cache left there.
+ */
+
+#include "syscall.h"
+
+#define SLAB_SIZE	1024	/* a power of 2 */
+#define SLAB_HEADER	16	/* room for a Slab, blocks stay 8-aligned */
+#define NCLASSES	6	/* blocks of 8, 16, ..., 256 bytes */
+#define MAX_SMALL	(8 << (NCLASSES - 1))
+#define LARGE		NCLASSES	/* class of a run of slabs */
+#define BATCH		8	/* blocks traded between a cache and the lists */
+#define MAX_CACHES	16	/* threads with a cache, by stack slot */
+
+typedef struct Slab {
+    int sizeClass;		/* of its blocks, or LARGE */
+    int slabs;			/* length of the run, for LARGE */
+    struct Slab *next;		/* next free run, for LARGE */
+} Slab;
+
+typedef struct Block {
+    struct Block *next;
+} Block;
+
+typedef struct {
+    Block *blocks[NCLASSES];	/* free blocks of each class */
+    int count[NCLASSES];
+} Cache;
+
+static Mutex heapLock;		/* protects all but the caches */
+static Block *freeBlocks[NCLASSES];	/* shared free lists */
+static char *carve[NCLASSES];	/* what is left of the last slab of */
+static char *carveEnd[NCLASSES];	/* each class, never used yet */
+static Slab *freeRuns;
+static char *heapEnd;		/* the break, once known */
+static Cache caches[MAX_CACHES];
+
+static int
+ThreadSlot (void)
+{
+    int slot;
+
+    __asm__ ("move %0,$27" : "=r" (slot));
+    return slot;
+}
+
+static int
+SizeClass (unsigned int size)
+{
+    int c = 0;
+
+    while ((8U << c) < size)
+        c++;
+    return c;
+}
+
+static Slab *
+SlabOf (void *ptr)
+{
+    return (Slab *) ((unsigned int) ptr & ~(SLAB_SIZE - 1));
+}
+
+/* Get a run of "count" new slabs from the kernel, or 0.  The heap
+ * lock is held.
+ */
+static Slab *
+NewSlabs (int count, int sizeClass)
+{
+    Slab *slab;
+    int pad;
+
+    if (heapEnd == 0)
+        heapEnd = Sbrk (0);
+    pad = -(int) heapEnd & (SLAB_SIZE - 1);
+    if (heapEnd == (char *) -1
+        || Sbrk (pad + count * SLAB_SIZE) == (void *) -1)
+        return 0;
+    slab = (Slab *) (heapEnd + pad);
+    heapEnd += pad + count * SLAB_SIZE;
+    slab->sizeClass = sizeClass;
+    slab->slabs = count;
+    return slab;
+}
+
+/* Move up to "n" free blocks of class "c" to "list", cutting a new
+ * slab if needed, and return how many.  The heap lock is held.
+ */
+static int
+TakeBlocks (int c, int n, Block **list)
+{
+    int taken = 0;
+    Block *block;
+
+    while (taken < n)
+      {
+          if (freeBlocks[c] != 0)
+            {
+                block = freeBlocks[c];
+                freeBlocks[c] = block->next;
+            }
+          else
+            {
+                if (carve[c] + (8 << c) > carveEnd[c])
+                  {
+                      Slab *slab = NewSlabs (1, c);
+
+                      if (slab == 0)
+                          break;
+                      carve[c] = (char *) slab + SLAB_HEADER;
+                      carveEnd[c] = (char *) slab + SLAB_SIZE;
+                  }
+                block = (Block *) carve[c];
+                carve[c] += 8 << c;
+            }
+          block->next = *list;
+          *list = block;
+          taken++;
+      }
+    return taken;
+}
+
+static void *
+LargeAlloc (unsigned int size)
+{
+    int count;
+    Slab **prev, *slab;
+
+    if (size > 0x7fffffffU - SLAB_HEADER - SLAB_SIZE)
+        return 0;               /* count or its bytes would overflow */
+    count = (size + SLAB_HEADER + SLAB_SIZE - 1) / SLAB_SIZE;
+
+    MutexLock (&heapLock);
+    for (prev = &freeRuns; (slab = *prev) != 0; prev = &slab->next)
+        if (slab->slabs >= count)
+          {
+              *prev = slab->next;
+              break;
+          }
+    if (slab == 0)
+        slab = NewSlabs (count, LARGE);
+    MutexUnlock (&heapLock);
+    return slab != 0 ? (char *) slab + SLAB_HEADER : 0;
+}
+
+static void
+LargeFree (Slab *slab)
+{
+    MutexLock (&heapLock);
+    if ((char *) slab + slab->slabs * SLAB_SIZE == heapEnd
+        && Sbrk (-slab->slabs * SLAB_SIZE) != (void *) -1)
+        heapEnd = (char *) slab;
+    else
+      {
+          slab->next = freeRuns;
+          freeRuns = slab;
+      }
+    MutexUnlock (&heapLock);
+}
+
+void *
+malloc (unsigned int size)
+{
+    Block *block = 0;
+    Cache *cache;
+    int c, slot;
+
+    if (size > MAX_SMALL)
+        return LargeAlloc (size);
+    c = SizeClass (size);
+    slot = ThreadSlot ();
+
+    if (slot >= MAX_CACHES)
+      {
+          MutexLock (&heapLock);
+          TakeBlocks (c, 1, &block);
+          MutexUnlock (&heapLock);
+          return block;
+      }
+
+    cache = &caches[slot];
+    if (cache->blocks[c] == 0)
+      {
+          MutexLock (&heapLock);
+          cache->count[c] += TakeBlocks (c, BATCH, &cache->blocks[c]);
+          MutexUnlock (&heapLock);
+          if (cache->blocks[c] == 0)
+              return 0;
+      }
+    block = cache->blocks[c];
+    cache->blocks[c] = block->next;
+    cache->count[c]--;
+    return block;
+}
+
+void
+free (void *ptr)
+{
+    Block *block = ptr;
+    Cache *cache;
+    int c, slot, i;
+
+    if (ptr == 0)
+        return;
+    c = SlabOf (ptr)->sizeClass;
+    if (c == LARGE)
+      {
+          LargeFree (SlabOf (ptr));
+          return;
+      }
+    slot = ThreadSlot ();
+
+    if (slot >= MAX_CACHES)
+      {
+          MutexLock (&heapLock);
+          block->next = freeBlocks[c];
+          freeBlocks[c] = block;
+          MutexUnlock (&heapLock);
+          return;
+      }
+
+    cache = &caches[slot];
+    block->next = cache->blocks[c];
+    cache->blocks[c] = block;
+    if (++cache->count[c] > 2 * BATCH)
+      {
+          MutexLock (&heapLock);
+          for (i = 0; i < BATCH; i++)
+            {
+                block = cache->blocks[c];
+                cache->blocks[c] = block->next;
+                block->next = freeBlocks[c];
+                freeBlocks[c] = block;
+            }
+          MutexUnlock (&heapLock);
+          cache->count[c] -= BATCH;
+      }
+}
+
+void *
+calloc (unsigned int count, unsigned int size)
+{
+    char *ptr;
+    unsigned int i;
+
+    if (size != 0 && count > 0xffffffffU / size)
+        return 0;
+    ptr = malloc (count * size);
+    if (ptr != 0)
+        for (i = 0; i < count * size; i++)
+            ptr[i] = 0;
+    return ptr;
+}
+
+void *
+realloc (void *ptr, unsigned int size)
+{
+    Slab *slab;
+    unsigned int room, i;
+    char *copy;
+
+    if (ptr == 0)
+        return malloc (size);
+    slab = SlabOf (ptr);
+    if (slab->sizeClass == LARGE)
+        room = slab->slabs * SLAB_SIZE - SLAB_HEADER;
+    else
+        room = 8 << slab->sizeClass;
+    if (size <= room)
+        return ptr;
+
+    copy = malloc (size);
+    if (copy != 0)
+      {
+          for (i = 0; i < room; i++)
+              copy[i] = ((char *) ptr)[i];
+          free (ptr);
+      }
+    return copy;
+}
@@ -0,0 +1,35 @@
+/* mmap.c
+ *	Test program for memory-mapped files.
+ *
+ *	Maps its own source privately, prints its first line straight
+ *	from the mapping, then scribbles over the mapped copy: the file
+ *	itself must stay untouched.  Run from the userprog directory.
+ */
+
+#include "syscall.h"
+
+int
+main ()
+{
+    OpenFileId id;
+    char *text;
+    int i;
+
+    id = Open ("../test/mmap.c");
+    if (id < 0)
+        Exit (1);
+    text = Mmap (id, 0, 4096, MAP_PRIVATE);
+    Close (id);                 /* the mapping keeps the file */
+    if (text == 0)
+        Exit (1);
+
+    for (i = 0; text[i] != '\n'; i++)
+        PutChar (text[i]);
+    PutChar ('\n');
+
+    for (i = 0; i < 1024; i++)
+        text[i] = 'x';
+    if (Munmap (text) != 0 || Munmap (text) != -1)
+        Exit (2);
+    Exit (0);
+}
@@ -0,0 +1,49 @@
+/* ring.c
+ *	Test program for the syscall ring, without a poller.
+ *
+ *	Prints 40 lines with one PutString each, then 40 more through the
+ *	ring, queued 8 at a time with a single RingEnter per batch, and
+ *	checks every completion.  Run with -strace to compare the number
+ *	of traps: 40 PutStrings, against 5 RingEnters.  ringpoll.c does
+ *	the same with RING_SQPOLL.
+ */
+
+#include "syscall.h"
+
+#define LINES 40
+
+Ring ring;
+
+int
+main ()
+{
+    int i, j;
+
+    for (i = 0; i < LINES; i++)
+        PutString ("plain line\n");
+
+    if (RingSetup (&ring, 0) != 0 || RingSetup (&ring, 0) != -1)
+        Exit (1);
+    for (i = 0; i < LINES; i += RING_ENTRIES)
+      {
+          for (j = 0; j < RING_ENTRIES; j++)
+            {
+                RingRequest *request = &ring.sq[ring.sqTail % RING_ENTRIES];
+
+                request->op = SC_PutString;
+                request->arg1 = (int) "ring line\n";
+                request->tag = i + j;
+                ring.sqTail++;
+            }
+          if (RingEnter () != RING_ENTRIES)
+              Exit (2);
+          for (j = 0; j < RING_ENTRIES; j++)
+            {
+                if (ring.cqHead == ring.cqTail
+                    || ring.cq[ring.cqHead % RING_ENTRIES].tag != i + j)
+                    Exit (3);
+                ring.cqHead++;
+            }
+      }
+    Exit (0);
+}
@@ -0,0 +1,54 @@
+/* ringpoll.c
+ *	Test program for the syscall ring, with a poller.
+ *
+ *	Queues 40 PutStrings through a RING_SQPOLL ring, 8 at a time, and
+ *	waits for their completions.  The kernel thread polling the ring
+ *	runs them; it only needs a RingEnter once it has set
+ *	RING_NEED_WAKEUP and gone to sleep, which is waited for half-way.
+ *	Run with -rs, for the poller to get the processor while this one
+ *	spins, and with -strace to count the traps.
+ */
+
+#include "syscall.h"
+
+#define LINES 40
+
+Ring shared;
+
+int
+main ()
+{
+    volatile Ring *ring = &shared;	/* the poller changes it */
+    int i, j;
+
+    if (RingSetup (&shared, RING_SQPOLL) != 0)
+        Exit (1);
+    for (i = 0; i < LINES; i += RING_ENTRIES)
+      {
+          for (j = 0; j < RING_ENTRIES; j++)
+            {
+                volatile RingRequest *request;
+
+                request = &ring->sq[ring->sqTail % RING_ENTRIES];
+
+                request->op = SC_PutString;
+                request->arg1 = (int) "polled line\n";
+                request->tag = i + j;
+                ring->sqTail++;
+            }
+          if (ring->flags & RING_NEED_WAKEUP)
+              RingEnter ();
+          for (j = 0; j < RING_ENTRIES; j++)
+            {
+                while (ring->cqHead == ring->cqTail)
+                    ;
+                if (ring->cq[ring->cqHead % RING_ENTRIES].tag != i + j)
+                    Exit (2);
+                ring->cqHead++;
+            }
+          if (i == 2 * RING_ENTRIES)
+              while (!(ring->flags & RING_NEED_WAKEUP))
+                  ;             /* the next batch needs a RingEnter */
+      }
+    Exit (0);
+}
@@ -8,6 +8,12 @@ main ()
     OpenFileId output = ConsoleOutput;
     char prompt[2], buffer[60];
     int i;
+#ifdef CHANGED
+    SpaceId lastProc;
+    OpenFileId ends[2];
+    char *second;
+    int j;
+#endif
 
     prompt[0] = '$';
     prompt[1] = ' ';
@@ -16,6 +22,15 @@ main ()
       {
           Write (prompt, 2, output);
 
+#ifdef CHANGED
+          // The console hands out whole lines: one Read per command
+          i = Read (buffer, sizeof buffer - 1, input);
+          if (i <= 0)
+              Exit (0);
+          if (buffer[i - 1] == '\n')
+              i--;
+          buffer[i] = '\0';
+#else
           i = 0;
 
           do
@@ -27,7 +42,38 @@ main ()
           while (buffer[i++] != '\n');
 
           buffer[--i] = '\0';
+#endif
 
+#ifdef CHANGED
+          // "a | b" runs a and b, with the output of a piped into b
+          second = 0;
+          for (j = 0; j < i; j++)
+              if (buffer[j] == '|')
+                {
+                    second = &buffer[j + 1];
+                    while (*second == ' ')
+                        second++;
+                    while (j > 0 && buffer[j - 1] == ' ')
+                        j--;
+                    buffer[j] = '\0';
+                    break;
+                }
+
+          if (second != 0)
+            {
+                if (Pipe (ends, 0) == 0)
+                  {
+                      newProc = ExecWith (buffer, input, ends[1]);
+                      lastProc = ExecWith (second, ends[0], output);
+                      // only the two commands hold the pipe now
+                      Close (ends[0]);
+                      Close (ends[1]);
+                      Join (newProc);
+                      Join (lastProc);
+                  }
+            }
+          else
+#endif
           if (i > 0)
             {
                 newProc = Exec (buffer);
@@ -0,0 +1,33 @@
+/* stackgrow.c
+ *	Test program for on-demand stack growth.
+ *
+ *	Each level of recursion uses more than a page of stack, so the
+ *	stack has to grow well beyond its initial page.  Run with a small
+ *	-sl to see the stack overflow being caught instead.
+ */
+
+#include "syscall.h"
+
+int
+recurse (int n)
+{
+    char frame[200];
+    int i;
+
+    for (i = 0; i < 200; i++)
+        frame[i] = n;
+    if (n > 0)
+        recurse (n - 1);
+    for (i = 0; i < 200; i++)
+        if (frame[i] != n)
+            Exit (1);
+    return n;
+}
+
+int
+main ()
+{
+    recurse (20);
+    PutString ("stack grown\n");
+    Exit (0);
+}
@@ -0,0 +1,57 @@
+/* threads.c
+ *	Test program for user threads.
+ *
+ *	Several threads bump a shared counter under a Mutex, each one
+ *	with a frame on its own stack, and main joins them all.  Run
+ *	with -rs to get them preempted in the middle of an update.
+ */
+
+#include "syscall.h"
+
+#define NTHREADS 4
+#define ROUNDS 500
+
+Mutex lock;
+int counter;
+
+int
+worker (void *arg)
+{
+    int frame[32];
+    int i;
+
+    for (i = 0; i < 32; i++)
+        frame[i] = (int) arg;
+    for (i = 0; i < ROUNDS; i++)
+      {
+          MutexLock (&lock);
+          counter = counter + 1;
+          MutexUnlock (&lock);
+      }
+    for (i = 0; i < 32; i++)
+        if (frame[i] != (int) arg)
+            return -1;
+    return (int) arg;
+}
+
+int
+main ()
+{
+    int ids[NTHREADS];
+    int i;
+
+    MutexInit (&lock);
+    for (i = 0; i < NTHREADS; i++)
+      {
+          ids[i] = ThreadCreate (worker, (void *) i);
+          if (ids[i] < 0)
+              Exit (1);
+      }
+    for (i = 0; i < NTHREADS; i++)
+        if (ThreadJoin (ids[i]) != i)
+            Exit (2);
+    if (counter != NTHREADS * ROUNDS)
+        Exit (3);
+    PutString ("threads done\n");
+    Exit (0);
+}
@@ -0,0 +1,31 @@
+/* zeropage.c
+ *	Test program for zero-fill-on-demand bss.
+ *
+ *	The static array is larger than the physical memory, but only a
+ *	few of its pages are ever written: the others stay mapped to the
+ *	shared zero frame, and must read as zeros.
+ */
+
+#include "syscall.h"
+
+#define N (16 * 1024)
+
+char big[N];
+
+int
+main ()
+{
+    int i;
+
+    for (i = 0; i < N; i += N / 4)
+        big[i] = 'a' + i / (N / 4);
+
+    for (i = 0; i < N; i++)
+        if (big[i] != 0 && i % (N / 4) != 0)
+            Exit (1);
+
+    PutChar (big[0]);
+    PutChar (big[N / 4]);
+    PutChar ('\n');
+    Exit (0);
+}
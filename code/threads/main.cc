@@ -61,6 +61,10 @@ main (int argc, char **argv)
 "Usage: nachos -d <debugflags> -rs <random seed #> -z -h\n"
 #ifdef USER_PROGRAM
 "       -s -x <nachos file> -c <consoleIn> <consoleOut>\n"
+#ifdef CHANGED
+"       -sl <stack size> -hl <heap size> -ksm <pages> <ticks>\n"
+"       -zswap <pool size> -ws <ticks> -pf -pt2 -sp -strace\n"
+#endif
 #endif
 #ifdef FILESYS
 "       -f -cp <unix file> <nachos file>\n"
@@ -81,6 +85,19 @@ main (int argc, char **argv)
 "-s causes user programs to be executed in single-step mode\n"
 "-x runs a user program\n"
 "-c tests the console\n"
+#ifdef CHANGED
+"-sl sets the size of the stack region of user programs, in bytes\n"
+"-hl sets the size of the heap region of user programs, in bytes\n"
+"-ksm merges identical user pages, scanning <pages> pages every <ticks> ticks\n"
+"-zswap swaps pages out to a compressed pool of <pool size> bytes, then to disk\n"
+"-ws samples working sets every <ticks> ticks, and suspends processes when\n"
+"    they do not fit in memory\n"
+"-pf records the pages touched by programs at startup, and prefetches them\n"
+"    on the next runs\n"
+"-pt2 gives user programs two-level page tables, for sparse address spaces\n"
+"-sp maps aligned runs of pages with single superpage entries when possible\n"
+"-strace logs every system call of user programs, with its result and ticks\n"
+#endif
 #endif
 #ifdef FILESYS
 "FILESYS\n"
@@ -88,7 +88,17 @@ Scheduler::FindNextToRun ()
 {
     if (halted)
         return NULL;
+#if defined(USER_PROGRAM) && defined(CHANGED)
+    Thread *thread;
+
+    // threads of suspended processes wait for their readmission
+    do
+        thread = (Thread *) readyList->Remove ();
+    while (thread != NULL && loadcontrol != NULL && loadcontrol->Park (thread));
+    return thread;
+#else
     return (Thread *) readyList->Remove ();
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -166,6 +176,10 @@ Scheduler::Run (Thread * nextThread)
           currentThread->RestoreUserState ();        // to restore, do it.
           currentThread->space->RestoreState ();
       }
+#ifdef CHANGED
+    if (kernelinfo != NULL)
+        kernelinfo->Switched ();
+#endif
 #endif
 }
 
@@ -29,6 +29,12 @@ class Scheduler:public dontcopythis
     // list, if any, and return thread.
     void Run (Thread * nextThread); // Cause nextThread to start running
     void Print (void);              // Print contents of ready list
+#ifdef CHANGED
+    int NumReady (void)             // Number of threads on the ready list
+    {
+        return readyList->Length ();
+    }
+#endif
 
   private:
     List * readyList;           // queue of threads that are ready to run,
@@ -104,6 +104,125 @@ Semaphore::V ()
     (void) interrupt->SetLevel (oldLevel);
 }
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// Lock::Lock
+//      Initialize a lock, so that it can be used for mutual exclusion.
+//      A lock is a binary semaphore which remembers its holder.
+//
+//      "debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+Lock::Lock (const char *debugName)
+{
+    name = debugName;
+    free = new Semaphore (debugName, 1);
+    owner = NULL;
+}
+
+Lock::~Lock ()
+{
+    ASSERT_MSG (owner == NULL, "Deleting lock \"%s\" while held\n", name);
+    delete free;
+}
+
+//----------------------------------------------------------------------
+// Lock::Acquire
+//      Wait until the lock is free, then take it.
+//----------------------------------------------------------------------
+
+void
+Lock::Acquire ()
+{
+    ASSERT_MSG (!isHeldByCurrentThread (), "Lock \"%s\" is already held\n", name);
+    free->P ();
+    owner = currentThread;
+}
+
+//----------------------------------------------------------------------
+// Lock::Release
+//      Give the lock back, waking up a waiter if any.
+//----------------------------------------------------------------------
+
+void
+Lock::Release ()
+{
+    ASSERT_MSG (isHeldByCurrentThread (), "Releasing lock \"%s\" not held\n", name);
+    owner = NULL;
+    free->V ();
+}
+
+bool
+Lock::isHeldByCurrentThread ()
+{
+    return owner == currentThread;
+}
+
+//----------------------------------------------------------------------
+// Condition::Condition
+//      Initialize a condition variable with nobody waiting on it.
+//
+//      "debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+Condition::Condition (const char *debugName)
+{
+    name = debugName;
+    waiters = new List;
+}
+
+Condition::~Condition ()
+{
+    ASSERT_MSG (waiters->IsEmpty (), "Deleting condition \"%s\" with waiters\n", name);
+    delete waiters;
+}
+
+//----------------------------------------------------------------------
+// Condition::Wait
+//      Release "conditionLock", sleep until signaled, and take the lock
+//      again.  Each waiter sleeps on its own semaphore, so that a Signal
+//      between the Release and the P is not lost.
+//----------------------------------------------------------------------
+
+void
+Condition::Wait (Lock * conditionLock)
+{
+    Semaphore waiter ("condition waiter", 0);
+
+    ASSERT (conditionLock->isHeldByCurrentThread ());
+    waiters->Append (&waiter);
+    conditionLock->Release ();
+    waiter.P ();
+    conditionLock->Acquire ();
+}
+
+//----------------------------------------------------------------------
+// Condition::Signal
+//      Wake up one waiter, if any.
+//----------------------------------------------------------------------
+
+void
+Condition::Signal (Lock * conditionLock)
+{
+    ASSERT (conditionLock->isHeldByCurrentThread ());
+    Semaphore *waiter = (Semaphore *) waiters->Remove ();
+    if (waiter != NULL)
+        waiter->V ();
+}
+
+//----------------------------------------------------------------------
+// Condition::Broadcast
+//      Wake up all waiters.
+//----------------------------------------------------------------------
+
+void
+Condition::Broadcast (Lock * conditionLock)
+{
+    ASSERT (conditionLock->isHeldByCurrentThread ());
+    while (!waiters->IsEmpty ())
+        ((Semaphore *) waiters->Remove ())->V ();
+}
+#else
 // Dummy functions -- so we can compile our later assignments
 // Note -- without a correct implementation of Condition::Wait(),
 // the test case in the network assignment won't work!
@@ -155,3 +274,4 @@ Condition::Broadcast (Lock * conditionLock)
     (void) conditionLock;
     ASSERT_MSG(FALSE, "TODO\n");
 }
+#endif
@@ -87,7 +87,12 @@ class Lock:public dontcopythis
 
   private:
     const char *name;           // for debugging
+#ifdef CHANGED
+    Semaphore *free;            // 1 when nobody holds the lock
+    Thread *owner;              // thread holding the lock, or NULL
+#else
     // plus some other stuff you'll need to define
+#endif
 };
 
 // The following class defines a "condition variable".  A condition
@@ -143,6 +148,10 @@ class Condition:public dontcopythis
 
   private:
     const char *name;
+#ifdef CHANGED
+    List *waiters;              // one Semaphore per waiting thread
+#else
     // plus some other stuff you'll need to define
+#endif
 };
 #endif // SYNCH_H
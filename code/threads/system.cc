@@ -11,6 +11,11 @@
 #ifdef __GLIBC__
 #include <malloc.h>
 #endif
+#ifdef CHANGED
+#ifdef USER_PROGRAM
+#include "syscall.h"
+#endif
+#endif
 
 // This defines *all* of the global data structures used by Nachos.
 // These are all initialized and de-allocated by this file.
@@ -35,6 +40,16 @@ SynchDisk *synchDisk;
 Machine *machine;		// user program memory and registers
     #ifdef CHANGED
         ConsoleDriver *consoledriver;
+        PageProvider *pageprovider;
+        ImageCache *imagecache;
+        MapCache *mapcache;
+        FileTable *filetable;
+        FutexTable *futextable;
+        ProcessTable *processTable;
+        Ksm *ksm;
+        SwapManager *swap;
+        LoadControl *loadcontrol;
+        KernelInfoFrame *kernelinfo;
     #endif
 #endif
 
@@ -91,6 +106,12 @@ Initialize (int argc, char **argv)
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+#ifdef CHANGED
+    int ksmPages = 0;		// pages merged per scan, 0 for no merging
+    int ksmTicks = 0;		// time between two scans
+    int zswapSize = -1;		// compressed swap pool, -1 for no swap
+    int wsTicks = 0;		// working set sampling period, 0 for none
+#endif
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
@@ -141,6 +162,55 @@ Initialize (int argc, char **argv)
 #ifdef USER_PROGRAM
           if (!strcmp (*argv, "-s"))
               debugUserProg = TRUE;
+#ifdef CHANGED
+          else if (!strcmp (*argv, "-sl"))
+            {
+                ASSERT_MSG (argc > 1, "-sl needs a stack size\n");
+                int limit = atoi (*(argv + 1));
+                ASSERT_MSG (limit > 0 && limit < KERNEL_INFO_ADDR,
+                            "-sl needs a positive stack size below %d\n", KERNEL_INFO_ADDR);
+                userStackLimit = limit;
+                argCount = 2;
+            }
+          else if (!strcmp (*argv, "-hl"))
+            {
+                ASSERT_MSG (argc > 1, "-hl needs a heap size\n");
+                int limit = atoi (*(argv + 1));
+                ASSERT_MSG (limit >= 0, "-hl needs a heap size of 0 or more\n");
+                userHeapLimit = limit;
+                argCount = 2;
+            }
+          else if (!strcmp (*argv, "-ksm"))
+            {
+                ASSERT_MSG (argc > 2, "-ksm needs a number of pages and a number of ticks\n");
+                ksmPages = atoi (*(argv + 1));
+                ksmTicks = atoi (*(argv + 2));
+                ASSERT_MSG (ksmPages > 0 && ksmTicks > 0, "-ksm needs positive parameters\n");
+                argCount = 3;
+            }
+          else if (!strcmp (*argv, "-zswap"))
+            {
+                ASSERT_MSG (argc > 1, "-zswap needs a pool size\n");
+                zswapSize = atoi (*(argv + 1));
+                ASSERT_MSG (zswapSize >= 0, "-zswap needs a pool size of 0 or more\n");
+                argCount = 2;
+            }
+          else if (!strcmp (*argv, "-pf"))
+              startupPrefetch = TRUE;
+          else if (!strcmp (*argv, "-pt2"))
+              twoLevelPageTables = TRUE;
+          else if (!strcmp (*argv, "-sp"))
+              superpages = TRUE;
+          else if (!strcmp (*argv, "-strace"))
+              straceSyscalls = TRUE;
+          else if (!strcmp (*argv, "-ws"))
+            {
+                ASSERT_MSG (argc > 1, "-ws needs a number of ticks\n");
+                wsTicks = atoi (*(argv + 1));
+                ASSERT_MSG (wsTicks > 0, "-ws needs a positive number of ticks\n");
+                argCount = 2;
+            }
+#endif
 #endif
 #ifdef FILESYS_NEEDED
           if (!strcmp (*argv, "-f"))
@@ -182,6 +252,21 @@ Initialize (int argc, char **argv)
 
 #ifdef USER_PROGRAM
     machine = new Machine (debugUserProg);	// this must come first
+#ifdef CHANGED
+    pageprovider = new PageProvider (NumPhysPages);
+    imagecache = new ImageCache ();
+    mapcache = new MapCache ();
+    filetable = new FileTable ();
+    futextable = new FutexTable ();
+    processTable = new ProcessTable (MaxProcesses);
+    kernelinfo = new KernelInfoFrame ();
+    if (ksmPages > 0)
+        ksm = new Ksm (ksmPages, ksmTicks);
+    if (zswapSize >= 0)
+        swap = new SwapManager (zswapSize);
+    if (wsTicks > 0)
+        loadcontrol = new LoadControl (wsTicks);
+#endif
 #endif
 
 #ifdef FILESYS
@@ -229,6 +314,48 @@ Cleanup ()
 #endif
 
 #ifdef USER_PROGRAM
+#ifdef CHANGED
+    if (loadcontrol) {
+        delete loadcontrol;
+        loadcontrol = NULL;
+    }
+    if (ksm) {
+        delete ksm;
+        ksm = NULL;
+    }
+    if (swap) {
+        delete swap;
+        swap = NULL;
+    }
+    if (kernelinfo) {
+        delete kernelinfo;
+        kernelinfo = NULL;
+    }
+    if (processTable) {
+        delete processTable;
+        processTable = NULL;
+    }
+    if (futextable) {
+        delete futextable;
+        futextable = NULL;
+    }
+    if (filetable) {
+        delete filetable;
+        filetable = NULL;
+    }
+    if (mapcache) {
+        delete mapcache;
+        mapcache = NULL;
+    }
+    if (imagecache) {
+        delete imagecache;
+        imagecache = NULL;
+    }
+    if (pageprovider) {
+        delete pageprovider;
+        pageprovider = NULL;
+    }
+#endif
     if (machine) {
         delete machine;
         machine = NULL;
@@ -35,8 +35,34 @@ extern Timer *timer;            // the hardware alarm clock
 extern Machine *machine;        // user program memory and registers
     #ifdef CHANGED
         #include "consoledriver.h"
+        #include "pageprovider.h"
+        #include "imagecache.h"
+        #include "process.h"
+        #include "ksm.h"
+        #include "swap.h"
+        #include "loadcontrol.h"
+        #include "prefetch.h"
+        #include "mmap.h"
+        #include "syscallring.h"
+        #include "kernelinfo.h"
+        #include "exception.h"
+        #include "filetable.h"
+        #include "aio.h"
+        #include "futex.h"
+        #include "userthread.h"
         extern ConsoleDriver *consoledriver;
-        #define MAX_STRING_SIZE 8
+        extern PageProvider *pageprovider;
+        extern ImageCache *imagecache;
+        extern MapCache *mapcache;
+        extern FileTable *filetable;
+        extern FutexTable *futextable;
+        extern ProcessTable *processTable;
+        extern Ksm *ksm;
+        extern SwapManager *swap;
+        extern LoadControl *loadcontrol;
+        extern KernelInfoFrame *kernelinfo;
+        #define MAX_STRING_SIZE 128
+        #define MAX_FILENAME_SIZE 256
     #endif
 #endif
 
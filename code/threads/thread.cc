@@ -61,10 +61,18 @@ Thread::Thread (const char *threadName)
 #ifdef USER_PROGRAM
     space = NULL;
 
+#ifdef CHANGED
+    // Kernel threads of a process (ring poller, I/O thread) never set
+    // them, but still get them restored, and the stack pointer read on
+    // their faults
+    for (int i = 0; i < NumTotalRegs; i++)
+        userRegisters[i] = 0;
+#else
     // must be explicitly set to 0 since when Enabling interrupts,
     // DelayedLoad is called !!!
     userRegisters[LoadReg] = 0;
     userRegisters[LoadValueReg] = 0;
+#endif
 #endif
     ThreadList.Append(this);
 
@@ -475,6 +483,9 @@ Thread::RestoreUserState ()
 {
     for (int i = 0; i < NumTotalRegs; i++)
         machine->WriteRegister (i, userRegisters[i]);
+#ifdef CHANGED
+    machine->linkedAddr = -1;	// another thread may have stored there
+#endif
 }
 
 //----------------------------------------------------------------------
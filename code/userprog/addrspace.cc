@@ -21,6 +21,9 @@
 #include "noff.h"
 #include "syscall.h"
 #include "new"
+#ifdef CHANGED
+#include "synch.h"
+#endif
 
 //----------------------------------------------------------------------
 // SwapHeader
@@ -54,6 +57,30 @@ SwapHeader (NoffHeader * noffH)
 // pageTable    : page table (translation from virtual to physical)
 // numPages     : number of pages in the page table
 
+#ifdef CHANGED
+static void ReadAtVirtual(OpenFile *executable, int virtualaddr,
+    int numBytes, int position, PageTable &pageTable,
+    unsigned numPages)
+{
+    char buffer[numBytes];
+    executable->ReadAt(buffer, numBytes, position);
+
+    TranslationEntry* oldTable = machine->currentPageTable;
+    TranslationEntry** oldDirectory = machine->currentPageDirectory;
+    unsigned int oldSize = machine->currentPageTableSize;
+
+    ASSERT(pageTable.NumPages() == numPages);
+    pageTable.Install();
+
+    for(int i = 0; i < numBytes; i++) {
+        machine->WriteMem(virtualaddr+i, 1, buffer[i]);
+    }
+
+    machine->currentPageTable = oldTable;
+    machine->currentPageDirectory = oldDirectory;
+    machine->currentPageTableSize = oldSize;
+}
+#else
 static void ReadAtVirtual(OpenFile *executable, int virtualaddr,
     int numBytes, int position, TranslationEntry *pageTable,
     unsigned numPages)
@@ -74,6 +101,7 @@ static void ReadAtVirtual(OpenFile *executable, int virtualaddr,
     machine->currentPageTable = oldTable;
     machine->currentPageTableSize = oldSize;
 }
+#endif
 
 //----------------------------------------------------------------------
 // AddrSpaceList
@@ -81,6 +109,44 @@ static void ReadAtVirtual(OpenFile *executable, int virtualaddr,
 //----------------------------------------------------------------------
 List AddrSpaceList;
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// userStackLimit
+//      Size of the stack region of each address space (-sl option)
+//----------------------------------------------------------------------
+unsigned int userStackLimit = UserStacksAreaSize;
+
+//----------------------------------------------------------------------
+// userHeapLimit
+//      Size of the heap region of each address space (-hl option)
+//----------------------------------------------------------------------
+unsigned int userHeapLimit = UserHeapAreaSize;
+
+//----------------------------------------------------------------------
+// superpages
+//      Whether address spaces reserve frames for superpages, see -sp.
+//----------------------------------------------------------------------
+
+bool superpages = FALSE;
+
+//----------------------------------------------------------------------
+// IsAddrSpace
+//      Is "space" an existing address space?  For kernel threads which
+//      keep pointers to address spaces across context switches.
+//----------------------------------------------------------------------
+
+bool
+IsAddrSpace (AddrSpace * space)
+{
+    ListElement *element;
+
+    for (element = AddrSpaceList.FirstElement (); element; element = element->next)
+        if (element->item == space)
+            return TRUE;
+    return FALSE;
+}
+#endif
+
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 //      Create an address space to run a user program.
@@ -108,6 +174,113 @@ AddrSpace::AddrSpace (OpenFile * executable)
     ASSERT_MSG (noffH.noffMagic == NOFFMAGIC, "This is not a nachos binary!\n");
 
 // how big is address space?
+#ifdef CHANGED
+    // The program image is followed by the stack region: one guard page,
+    // which is never mapped, then userStackLimit bytes of stack, which
+    // only get backed as the stack grows down into them.
+    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size;
+    stackBottom = divRoundUp (size, PageSize) + 1;
+    numPages = stackBottom + divRoundUp (userStackLimit, PageSize);
+    stackTop = numPages;
+    size = numPages * PageSize;
+
+    // Only the pages holding code or initialized data need a frame of
+    // their own.  Everything else (bss, stack) starts as zeros, and
+    // is mapped to the shared zero frame until it is first written.
+    unsigned int imageEnd = 0;
+    if (noffH.code.size > 0)
+        imageEnd = noffH.code.virtualAddr + noffH.code.size;
+    if (noffH.initData.size > 0)
+        imageEnd = std::max (imageEnd, (unsigned) (noffH.initData.virtualAddr
+                                                   + noffH.initData.size));
+    unsigned int loadedPages = divRoundUp (imageEnd, PageSize);
+    ASSERT (loadedPages < stackBottom);
+
+    // The code pages which hold nothing else are shared with the other
+    // address spaces running the same executable, through the image
+    // cache.  Page 0 is never mapped, so it is not part of the image.
+    unsigned int codeStart = noffH.code.virtualAddr;
+    unsigned int codeEnd = codeStart + noffH.code.size;
+    unsigned int textFirst = 0, textPages = 0;
+    if (noffH.code.size > 0 && codeStart % PageSize == 0)
+      {
+        textFirst = std::max (1U, codeStart / PageSize);
+        if (codeEnd / PageSize > textFirst)
+            textPages = codeEnd / PageSize - textFirst;
+      }
+
+    int neededFrames = loadedPages - textPages;
+    if (textPages > 0 && imagecache->Find (executable->HeaderSector ()) == NULL)
+        neededFrames += textPages;
+    if (neededFrames > pageprovider->NumAvailPage () && swap == NULL)
+            throw std::bad_alloc();
+    // The kernel info page must stay at its fixed address, past the
+    // stack region
+    if (stackTop > KernelInfoPage)
+            throw std::bad_alloc();
+
+    text = NULL;
+    if (textPages > 0)
+      {
+        text = imagecache->Acquire (executable, textFirst, textPages,
+                                    noffH.code.inFileAddr
+                                    + textFirst * PageSize - codeStart);
+        if (text == NULL)
+            throw std::bad_alloc();
+      }
+
+    DEBUG ('a', "Initializing address space, num pages %d, total size 0x%x, %d pages loaded, %d shared\n",
+           numPages, size, loadedPages, textPages);
+// first, set up the translation
+    // Every page starts invalid; the stack guard page and the stack
+    // not grown yet stay so, and need no entry in a two-level table.
+    pageTable.Resize (numPages);
+    workingSet = peakWorkingSet = 0;
+    profile = NULL;
+    ring = NULL;
+    files = new FileDescriptors ();
+    aio = NULL;
+    heapBottom = heapPages = 0;
+    heapBreak = 0;
+    threads = new UserThreads (stackBottom, stackTop);
+    faultLock = new Lock ("page faults");
+    outOfFrames = FALSE;
+    for (i = 0; i < numPages; i++)
+      {
+        if (i >= textFirst && i < textFirst + textPages)
+          {
+            pageTable[i].physicalPage = text->frames[i - textFirst];
+            pageTable[i].readOnly = TRUE;
+            pageprovider->ShareFrame (pageTable[i].physicalPage);
+          }
+        else if (i < loadedPages)
+          {
+            int frame = AllocFrame (i);
+            ASSERT_MSG (frame >= 0, "Out of frames while loading page %d\n", i);
+            pageTable[i].physicalPage = frame;
+          }
+        else if (i < stackBottom - 1 || i == numPages - 1)
+          {
+            // bss, or the top page of the stack
+            pageTable[i].physicalPage = pageprovider->ZeroFrame ();
+            pageTable[i].readOnly = TRUE;
+            pageTable.Flags (i) = PageCopyOnWrite;
+            stats->numZeroPageHits++;
+          }
+        else
+            continue;
+        pageTable[i].valid = TRUE;
+        TryPromote (i);
+      }
+
+    // The kernel info page goes at its fixed address
+    numPages = KernelInfoPage + 1;
+    pageTable.Resize (numPages);
+    pageTable[KernelInfoPage].physicalPage = kernelinfo->Frame ();
+    pageTable[KernelInfoPage].readOnly = TRUE;
+    pageTable[KernelInfoPage].valid = TRUE;
+    pageprovider->ShareFrame (kernelinfo->Frame ());
+#else
     size = noffH.code.size + noffH.initData.size + noffH.uninitData.size + UserStacksAreaSize;	// we need to increase the size
     // to leave room for the stack
     numPages = divRoundUp (size, PageSize);
@@ -134,8 +307,30 @@ AddrSpace::AddrSpace (OpenFile * executable)
         // a separate page, we could set its
         // pages to be read-only
       }
+#endif
 
 // then, copy in the code and data segments into memory
+#ifdef CHANGED
+    if (noffH.code.size > 0)
+      {
+        // Only the code outside of the shared text image is loaded here
+        unsigned int textStart = codeEnd, textEnd = codeEnd;
+        if (textPages > 0)
+          {
+            textStart = textFirst * PageSize;
+            textEnd = (textFirst + textPages) * PageSize;
+          }
+        DEBUG ('a', "Initializing code segment, at 0x%x, size 0x%x, shared 0x%x-0x%x\n",
+               codeStart, noffH.code.size, textStart, textEnd);
+        if (codeStart < textStart)
+            ReadAtVirtual(executable, codeStart, textStart - codeStart,
+                          noffH.code.inFileAddr, pageTable, numPages);
+        if (textEnd < codeEnd)
+            ReadAtVirtual(executable, textEnd, codeEnd - textEnd,
+                          noffH.code.inFileAddr + textEnd - codeStart,
+                          pageTable, numPages);
+      }
+#else
     if (noffH.code.size > 0)
       {
         DEBUG ('a', "Initializing code segment, at 0x%x, size 0x%x\n",
@@ -144,6 +339,7 @@ AddrSpace::AddrSpace (OpenFile * executable)
         // executable->ReadAt (&(machine->mainMemory[noffH.code.virtualAddr]),
         //                     noffH.code.size, noffH.code.inFileAddr);
       }
+#endif
     if (noffH.initData.size > 0)
       {
         DEBUG ('a', "Initializing data segment, at 0x%x, size 0x%x\n",
@@ -153,27 +349,924 @@ AddrSpace::AddrSpace (OpenFile * executable)
         //                     noffH.initData.size, noffH.initData.inFileAddr);
       }
 
+#ifdef CHANGED
+    DEBUG ('a', "Area for stacks at 0x%x, size 0x%x\n",
+           stackBottom * PageSize, size - stackBottom * PageSize);
+#else
     DEBUG ('a', "Area for stacks at 0x%x, size 0x%x\n",
            size - UserStacksAreaSize, UserStacksAreaSize);
+#endif
 
     pageTable[0].valid = FALSE;			// Catch NULL dereference
+#ifdef CHANGED
+    pageprovider->ReleasePage (pageTable[0].physicalPage);
+#endif
 
     AddrSpaceList.Append(this);
 }
 
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-//      Dealloate an address space.  Nothing for now!
+//      Dealloate an address space, and give its frames back.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace ()
 {
+#ifdef CHANGED
+  UnmapAll ();
+  for (unsigned int i = 0; i < numPages; i++)
+    if (!pageTable.Populated (i))
+      continue;
+    else if (pageTable[i].valid)
+      pageprovider->ReleasePage (pageTable[i].physicalPage);
+    else if (pageTable.Flags (i) & PageSwapped)
+      swap->FreeSlot (pageTable[i].physicalPage);
+  DEBUG ('a', "Page table of %p: %d pages, %d bytes\n", this, numPages,
+         pageTable.Bytes ());
+  while (!reservations.IsEmpty ())
+    {
+      SuperpageRun *run = (SuperpageRun *) reservations.Remove ();
+      pageprovider->CancelRun (run->firstFrame, this);
+      delete run;
+    }
+  delete ring;                  // stopped by ExitProcess
+  ring = NULL;
+  delete aio;                   // stopped by ExitProcess
+  aio = NULL;
+  delete files;
+  files = NULL;
+  delete threads;
+  threads = NULL;
+  delete faultLock;
+  faultLock = NULL;
+  delete profile;
+  profile = NULL;
+  if (text != NULL)
+    imagecache->Release (text);
+#else
   delete [] pageTable;
   pageTable = NULL;
+#endif
 
   AddrSpaceList.Remove(this);
 }
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// AddrSpace::CopyOnWrite
+//      Called on a write to a read-only page.  If the page is a
+//      copy-on-write mapping of a shared frame, give it a private
+//      writable frame holding the same contents and return TRUE.
+//      Return FALSE if the page is really read-only.
+//
+//      "virtAddr" is the faulting virtual address
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::CopyOnWrite (int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+
+    if (vpn >= numPages || !pageTable[vpn].valid
+        || !(pageTable.Flags (vpn) & PageCopyOnWrite))
+        return FALSE;
+
+    int oldFrame = pageTable[vpn].physicalPage;
+    if (oldFrame != pageprovider->ZeroFrame ()
+        && pageprovider->RefCount (oldFrame) == 1)
+      {
+        // Everybody else let go of it meanwhile, just take it over
+        DEBUG ('a', "Taking over frame %d for page %d\n", oldFrame, vpn);
+      }
+    else
+      {
+        int newFrame = AllocFrame (vpn);
+        if (newFrame < 0)
+          {
+            DEBUG ('a', "Out of frames for copy-on-write of page %d\n", vpn);
+            outOfFrames = TRUE;
+            return FALSE;
+          }
+        if (oldFrame == pageprovider->ZeroFrame ())
+          {
+            stats->numZeroPageCopies++;   // already zero-filled
+            if (profile != NULL)
+                profile->Record (vpn);
+          }
+        else
+            memcpy (&machine->mainMemory[newFrame * PageSize],
+                    &machine->mainMemory[oldFrame * PageSize], PageSize);
+        pageprovider->ReleasePage (oldFrame);
+        pageTable[vpn].physicalPage = newFrame;
+        DEBUG ('a', "Copy on write of page %d: frame %d -> %d\n",
+               vpn, oldFrame, newFrame);
+      }
+
+    if (pageTable.Flags (vpn) & PageMerged)
+        stats->numKsmUnmerged++;
+    pageTable[vpn].readOnly = FALSE;
+    pageTable.Flags (vpn) &= ~(PageCopyOnWrite | PageMerged);
+    TryPromote (vpn);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PrivateFrame
+//      Return the frame of page "vpn" if the page is a private writable
+//      mapping, which could be merged with an identical page or swapped
+//      out, else -1.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::PrivateFrame (unsigned int vpn)
+{
+    if (!pageTable.Populated (vpn) || !pageTable[vpn].valid
+        || pageTable[vpn].readOnly)
+        return -1;
+
+    int frame = pageTable[vpn].physicalPage;
+    if (pageprovider->RefCount (frame) != 1)
+        return -1;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MapsFrame
+//      Is page "vpn" currently mapped to "frame"?
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::MapsFrame (unsigned int vpn, int frame)
+{
+    return pageTable.Populated (vpn) && pageTable[vpn].valid
+        && (int) pageTable[vpn].physicalPage == frame;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MergePage
+//      Make page "vpn" a copy-on-write mapping of "frame", which holds
+//      the same contents as the page.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::MergePage (unsigned int vpn, int frame)
+{
+    int oldFrame = pageTable[vpn].physicalPage;
+
+    Demote (vpn);
+
+    if (oldFrame != frame)
+      {
+        pageprovider->ShareFrame (frame);
+        pageprovider->ReleasePage (oldFrame);
+        pageTable[vpn].physicalPage = frame;
+      }
+    pageTable[vpn].readOnly = TRUE;
+    pageTable.Flags (vpn) |= PageCopyOnWrite | PageMerged;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TestAndClearUse
+//      Return whether page "vpn" was accessed since the last call.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::TestAndClearUse (unsigned int vpn)
+{
+    bool used = TestUse (vpn, TRUE);
+
+    if (used)
+        pageTable.Flags (vpn) |= PageReferenced;   // for SampleWorkingSet
+    return used;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageOut
+//      Unmap page "vpn", which is being saved in swap "slot".  The
+//      caller gives its frame back.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::PageOut (unsigned int vpn, int slot)
+{
+    Demote (vpn);
+    pageTable[vpn].valid = FALSE;
+    pageTable[vpn].physicalPage = slot;
+    pageTable.Flags (vpn) |= PageSwapped;
+#ifdef USE_TLB
+    for (int i = 0; i < TLBSize; i++)
+        if (machine->tlb[i].valid && machine->tlb[i].virtualPage == vpn)
+            machine->tlb[i].valid = FALSE;
+#endif
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageIn
+//      Called on a page fault.  If the page of "virtAddr" is swapped
+//      out, bring it back into a frame and return TRUE.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PageIn (int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+
+    if (!pageTable.Populated (vpn) || pageTable[vpn].valid
+        || !(pageTable.Flags (vpn) & PageSwapped))
+        return FALSE;
+
+    int frame = AllocFrame (vpn);       // may evict another page
+    if (frame < 0)
+      {
+        DEBUG ('a', "Out of frames for page-in of page %d\n", vpn);
+        outOfFrames = TRUE;
+        return FALSE;
+      }
+    swap->SwapIn (pageTable[vpn].physicalPage, frame);
+    DEBUG ('a', "Page %d swapped in from slot %d to frame %d\n",
+           vpn, pageTable[vpn].physicalPage, frame);
+
+    pageTable[vpn].physicalPage = frame;
+    pageTable[vpn].valid = TRUE;
+    pageTable[vpn].dirty = FALSE;
+    pageTable.Flags (vpn) &= ~PageSwapped;
+    stats->numPageFaults++;
+    TryPromote (vpn);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SampleWorkingSet
+//      Shift the use bit of every page into its history, clear it, and
+//      return the number of pages used during the last
+//      WorkingSetWindow samples.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::SampleWorkingSet (void)
+{
+    workingSet = 0;
+    for (unsigned int i = 0; i < numPages; i++)
+      {
+        if (!pageTable.Populated (i))
+            continue;
+        pageTable.History (i) >>= 1;
+        if ((pageTable[i].valid && TestUse (i, TRUE))
+            || (pageTable.Flags (i) & PageReferenced))
+            pageTable.History (i) |= 1 << (WorkingSetWindow - 1);
+        pageTable.Flags (i) &= ~PageReferenced;
+        if (pageTable.History (i) != 0)
+            workingSet++;
+      }
+    if (workingSet > peakWorkingSet)
+        peakWorkingSet = workingSet;
+    return workingSet;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::GrowStack
+//      Called on a page fault.  If "virtAddr" is in the stack region,
+//      not further below the stack pointer than StackGrowthSlack, and in
+//      the stack of the current thread (see UserThreads::GrowthLimit),
+//      back every page from there up to the current bottom of that stack
+//      and return TRUE.  Return FALSE if a frame runs out on the way.
+//
+//      "virtAddr" is the faulting virtual address
+//      "stackPointer" is the user stack pointer at the time of the fault
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::GrowStack (int virtAddr, int stackPointer)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+
+    if (vpn < stackBottom || vpn >= stackTop || pageTable[vpn].valid)
+        return FALSE;
+    if (virtAddr < stackPointer - (int) StackGrowthSlack)
+        return FALSE;
+
+    // only within the stack of the faulting thread
+    unsigned int limit = threads->GrowthLimit (vpn);
+    if (limit == 0)
+        return FALSE;
+    for (unsigned int page = vpn; page < limit && !pageTable[page].valid; page++)
+      {
+        int frame = AllocFrame (page);
+        if (frame < 0)
+          {
+            DEBUG ('a', "Out of frames while growing the stack to page %d\n", page);
+            outOfFrames = TRUE;
+            return FALSE;
+          }
+        pageTable[page].physicalPage = frame;
+        pageTable[page].valid = TRUE;
+        TryPromote (page);
+        DEBUG ('a', "Stack grown to page %d, frame %d\n", page, frame);
+        if (profile != NULL)
+            profile->Record (page);
+      }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Prefetch
+//      Take ownership of "profile", back the pages it lists, and record
+//      into it the pages that still fault while the program starts.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::Prefetch (StartupProfile * startupProfile)
+{
+    delete profile;
+    profile = startupProfile;
+    profile->Prefetch (this);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PrefetchPage
+//      Give page "vpn" its own zero-filled frame if it would otherwise
+//      fault on first touch: a copy-on-write mapping of the zero frame,
+//      or an unbacked stack page.  Prefetching leaves PrefetchReserve
+//      frames free.  Return TRUE if the page was backed.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PrefetchPage (unsigned int vpn)
+{
+    int frame;
+
+    if (vpn >= numPages || pageprovider->NumAvailPage () <= PrefetchReserve)
+        return FALSE;
+
+    if (pageTable[vpn].valid && (pageTable.Flags (vpn) & PageCopyOnWrite)
+        && (int) pageTable[vpn].physicalPage == pageprovider->ZeroFrame ())
+      {
+        frame = AllocFrame (vpn);
+        pageTable[vpn].readOnly = FALSE;
+        pageTable.Flags (vpn) &= ~(PageCopyOnWrite | PageMerged);
+      }
+    else if (!pageTable[vpn].valid && vpn >= stackBottom && vpn < stackTop
+             && !(pageTable.Flags (vpn) & PageSwapped))
+      {
+        frame = AllocFrame (vpn);
+        pageTable[vpn].valid = TRUE;
+      }
+    else
+        return FALSE;
+
+    pageTable[vpn].physicalPage = frame;
+    TryPromote (vpn);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SaveProfile
+//      Save the startup profile of the program, if it is recorded.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::SaveProfile (void)
+{
+    if (profile != NULL)
+        profile->Save ();
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Mmap
+//      Map "length" bytes of file "name", from "offset" on, into a free
+//      range of pages past the stack region, extending the page table
+//      if needed.  Pages are read in on the first access.  Return the
+//      virtual address of the mapping, or 0 if the file cannot be
+//      opened, or the range is empty or not page-aligned.
+//
+//      "flags" is MAP_SHARED or MAP_PRIVATE
+//----------------------------------------------------------------------
+
+int
+AddrSpace::Mmap (int id, int offset, int length, int flags)
+{
+    SharedFile *shared = files->FileOf (id);
+
+    if (shared == NULL || offset < 0 || offset % PageSize != 0 || length <= 0)
+        return 0;
+
+    MappedFile *file = mapcache->Acquire (shared);
+    length = std::min (length, file->length - offset);
+    if (length <= 0)
+      {
+        mapcache->Release (file);
+        return 0;
+      }
+
+    Mapping *mapping = new Mapping;
+    mapping->numPages = divRoundUp (length, PageSize);
+    mapping->firstPage = FindMapRange (mapping->numPages);
+    mapping->filePage = offset / PageSize;
+    mapping->file = file;
+    mapping->shared = (flags & MAP_SHARED) != 0;
+    mappings.Append (mapping);
+
+    DEBUG ('a', "Mapped %d pages of file %d at page %d, %s\n",
+           mapping->numPages, id, mapping->firstPage,
+           mapping->shared ? "shared" : "private");
+    return mapping->firstPage * PageSize;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Munmap
+//      Remove the mapping starting at "virtAddr", writing its dirty
+//      pages back if it is shared.  Return 0, or -1 if there is no
+//      mapping there.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::Munmap (int virtAddr)
+{
+    ListElement *element;
+
+    for (element = mappings.FirstElement (); element; element = element->next)
+      {
+        Mapping *mapping = (Mapping *) element->item;
+        if (mapping->firstPage * PageSize == (unsigned) virtAddr)
+          {
+            Unmap (mapping);
+            return 0;
+          }
+      }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::UnmapAll
+//      Remove every mapping, on exit.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::UnmapAll (void)
+{
+    while (!mappings.IsEmpty ())
+        Unmap ((Mapping *) mappings.FirstElement ()->item);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MapIn
+//      Called on a page fault.  If "virtAddr" is in a mapping, read its
+//      page in and return TRUE.  Return FALSE if no frame is left.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::MapIn (int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    Mapping *mapping = FindMapping (vpn);
+
+    if (mapping == NULL || pageTable[vpn].valid
+        || (pageTable.Flags (vpn) & PageSwapped))
+        return FALSE;
+
+    int page = mapping->filePage + vpn - mapping->firstPage;
+    int frame = mapping->shared ? mapcache->SharedPage (mapping->file, page)
+                                : mapcache->PrivatePage (mapping->file, page);
+    if (frame < 0)
+      {
+        DEBUG ('a', "Out of frames for mapped page %d\n", vpn);
+        outOfFrames = TRUE;
+        return FALSE;
+      }
+
+    pageTable[vpn].physicalPage = frame;
+    pageTable[vpn].valid = TRUE;
+    pageTable[vpn].dirty = FALSE;
+    stats->numPageFaults++;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Sbrk
+//      Move the end of the heap by "increment" bytes, and return where
+//      it was, or -1 if it would leave the heap region.  The region,
+//      userHeapLimit bytes, is set aside among the mappings on the first
+//      call.  Pages get backed on the first access below the break, and
+//      the ones left wholly above it are given back.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::Sbrk (int increment)
+{
+    faultLock->Acquire ();
+    if (heapPages == 0)
+      {
+        unsigned int count = divRoundUp (userHeapLimit, PageSize);
+
+        if (count == 0)
+          {
+            faultLock->Release ();
+            return -1;
+          }
+        heapBottom = FindMapRange (count);
+        heapPages = count;
+        heapBreak = heapBottom * PageSize;
+        DEBUG ('a', "Heap of %d pages at page %d\n", heapPages, heapBottom);
+      }
+
+    int oldBreak = heapBreak;
+    if (increment > (int) ((heapBottom + heapPages) * PageSize) - oldBreak
+        || increment < (int) (heapBottom * PageSize) - oldBreak)
+      {
+        faultLock->Release ();
+        return -1;
+      }
+    heapBreak = oldBreak + increment;
+
+    for (unsigned int vpn = divRoundUp (heapBreak, PageSize);
+         vpn < (unsigned) divRoundUp (oldBreak, PageSize); vpn++)
+        if (pageTable.Populated (vpn)
+            && (pageTable[vpn].valid || (pageTable.Flags (vpn) & PageSwapped)))
+          {
+            FreePage (vpn);
+            stats->numHeapPagesFreed++;
+          }
+    faultLock->Release ();
+    return oldBreak;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::HeapIn
+//      Called on a page fault.  If "virtAddr" is in the heap, below the
+//      break, back its page with a zero-filled frame and return TRUE.
+//      Return FALSE if no frame is left.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::HeapIn (int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+
+    if (!InHeap (vpn) || vpn >= (unsigned) divRoundUp (heapBreak, PageSize)
+        || pageTable[vpn].valid || (pageTable.Flags (vpn) & PageSwapped))
+        return FALSE;
+
+    int frame = AllocFrame (vpn);
+    if (frame < 0)
+      {
+        DEBUG ('a', "Out of frames for heap page %d\n", vpn);
+        outOfFrames = TRUE;
+        return FALSE;
+      }
+    pageTable[vpn].physicalPage = frame;
+    pageTable[vpn].valid = TRUE;
+    stats->numHeapPages++;
+    DEBUG ('a', "Heap page %d backed by frame %d\n", vpn, frame);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ResolveFault
+//      Try every way of backing "virtAddr" after a translation of it
+//      failed with "which": swap-in, mapped file, heap, stack growth, or
+//      copy-on-write.  Return FALSE if the address is really bad, or if
+//      no frame is left for it (see FaultOutOfFrames).
+//
+//      The threads of the program take turns, since backing a page may
+//      block; a fault which another thread resolved meanwhile is done.
+//
+//      "stackPointer" is the user stack pointer, for stack growth
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::ResolveFault (ExceptionType which, int virtAddr, int stackPointer)
+{
+    int physAddr;
+    bool resolved;
+
+    faultLock->Acquire ();
+    outOfFrames = FALSE;
+    if (machine->Translate (virtAddr, &physAddr, 1,
+                            which == ReadOnlyException, FALSE) == NoException)
+        resolved = TRUE;
+    else
+        switch (which)
+          {
+            case PageFaultException:
+              resolved = virtAddr != 0
+                  && (PageIn (virtAddr) || MapIn (virtAddr)
+                      || HeapIn (virtAddr)
+                      || GrowStack (virtAddr, stackPointer));
+              break;
+            case ReadOnlyException:
+              resolved = CopyOnWrite (virtAddr);
+              break;
+            default:
+              resolved = FALSE;
+          }
+    faultLock->Release ();
+    return resolved;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SetupRing
+//      Serve the syscall ring at user address "ringAddr", with the
+//      RingSetup "flags".  Return 0, or -1 if there is already a ring or
+//      "ringAddr" is bad.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::SetupRing (int ringAddr, int flags)
+{
+    if (ring != NULL || !SyscallRing::IsValid (ringAddr))
+        return -1;
+    ring = new SyscallRing (this, ringAddr, flags);
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::GetAio
+//      Return the asynchronous I/O queue, starting it on first use if
+//      "start", else NULL if it was never started.
+//----------------------------------------------------------------------
+
+AioQueue *
+AddrSpace::GetAio (bool start)
+{
+    if (aio == NULL && start)
+        aio = new AioQueue (this);
+    return aio;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FindMapping
+//      Return the mapping containing page "vpn", or NULL.
+//----------------------------------------------------------------------
+
+Mapping *
+AddrSpace::FindMapping (unsigned int vpn)
+{
+    ListElement *element;
+
+    for (element = mappings.FirstElement (); element; element = element->next)
+      {
+        Mapping *mapping = (Mapping *) element->item;
+        if (vpn >= mapping->firstPage
+            && vpn < mapping->firstPage + mapping->numPages)
+            return mapping;
+      }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FindMapRange
+//      Return the first page of "count" consecutive pages past the stack
+//      region that no mapping, nor the heap, uses, growing the page table
+//      if there is no such range yet.
+//----------------------------------------------------------------------
+
+unsigned int
+AddrSpace::FindMapRange (unsigned int count)
+{
+    unsigned int first = stackTop, page;
+
+    for (page = stackTop; page < numPages && page - first < count; page++)
+        if (FindMapping (page) != NULL || page == KernelInfoPage
+            || InHeap (page))
+            first = page + 1;
+    if (first + count <= numPages)
+        return first;
+
+    numPages = first + count;
+    pageTable.Resize (numPages);
+    if (currentThread->space == this)
+        RestoreState ();
+    return first;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Unmap
+//      Give back the pages of "mapping", writing back the dirty ones if
+//      it is shared, and forget it.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::Unmap (Mapping * mapping)
+{
+    for (unsigned int i = 0; i < mapping->numPages; i++)
+      {
+        unsigned int vpn = mapping->firstPage + i;
+        int frame = pageTable[vpn].physicalPage;
+
+        Demote (vpn);
+
+        if (pageTable[vpn].valid && mapping->shared && pageTable[vpn].dirty)
+            mapcache->WriteBack (mapping->file, mapping->filePage + i, frame);
+        FreePage (vpn);
+      }
+    DEBUG ('a', "Unmapped %d pages at page %d\n", mapping->numPages,
+           mapping->firstPage);
+    mapcache->Release (mapping->file);
+    mappings.Remove (mapping);
+    delete mapping;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FreePage
+//      Give back the frame or swap slot of page "vpn", and leave the
+//      page invalid, as if it had never been touched.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::FreePage (unsigned int vpn)
+{
+    if (pageTable[vpn].valid)
+        pageprovider->ReleasePage (pageTable[vpn].physicalPage);
+    else if (pageTable.Flags (vpn) & PageSwapped)
+        swap->FreeSlot (pageTable[vpn].physicalPage);
+    pageTable[vpn].valid = FALSE;
+    pageTable[vpn].dirty = FALSE;
+    pageTable[vpn].use = FALSE;
+    pageTable[vpn].readOnly = FALSE;
+    pageTable.Flags (vpn) = 0;
+    pageTable.History (vpn) = 0;
+#ifdef USE_TLB
+    for (int j = 0; j < TLBSize; j++)
+        if (machine->tlb[j].valid && machine->tlb[j].virtualPage == vpn)
+            machine->tlb[j].valid = FALSE;
+#endif
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AllocFrame
+//      Allocate a zero-filled frame for page "vpn".  With superpages,
+//      the frame is taken out of an aligned run reserved for the
+//      SuperPagePages pages around "vpn", so that they can be promoted
+//      once they are all populated.  Return -1 if out of frames.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::AllocFrame (unsigned int vpn)
+{
+    unsigned int first = vpn - vpn % SuperPagePages;
+    ListElement *element;
+    SuperpageRun *run = NULL;
+
+    if (!superpages || !SuperpageCandidate (first))
+        return pageprovider->GetEmptyPage ();
+
+    for (element = reservations.FirstElement (); element; element = element->next)
+        if (((SuperpageRun *) element->item)->firstPage == first)
+          {
+            run = (SuperpageRun *) element->item;
+            break;
+          }
+    if (run == NULL)
+      {
+        int firstFrame = pageprovider->ReserveRun (this);
+        if (firstFrame < 0)
+            return pageprovider->GetEmptyPage ();
+        run = new SuperpageRun;
+        run->firstPage = first;
+        run->firstFrame = firstFrame;
+        reservations.Append (run);
+      }
+
+    int frame = pageprovider->TakeReserved (run->firstFrame + vpn - first, this);
+    if (frame < 0)
+        frame = pageprovider->GetEmptyPage ();  // reservation broken
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SuperpageCandidate
+//      Can the SuperPagePages pages from "first" on ever be promoted,
+//      i.e. are they all private pages of the program or its stack?
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::SuperpageCandidate (unsigned int first)
+{
+    unsigned int last = first + SuperPagePages - 1;
+
+    if (first == 0 || last >= stackTop)
+        return FALSE;           // page 0, or a file mapping
+    if (first <= stackBottom - 1 && last >= stackBottom - 1)
+        return FALSE;           // stack guard page
+    if (text != NULL && first < (unsigned) (text->firstPage + text->numPages)
+        && last >= (unsigned) text->firstPage)
+        return FALSE;           // shared code
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TryPromote
+//      Called when page "vpn" gets a private writable frame.  If all the
+//      pages of its superpage now map the aligned run of frames they
+//      were reserved, turn the first entry into a superpage entry.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::TryPromote (unsigned int vpn)
+{
+    unsigned int first = vpn - vpn % SuperPagePages;
+    ListElement *element;
+
+    if (!superpages || !SuperpageCandidate (first))
+        return;
+
+    int firstFrame = pageTable[first].physicalPage;
+    if (firstFrame % SuperPagePages != 0)
+        return;
+    for (unsigned int i = 0; i < SuperPagePages; i++)
+      {
+        TranslationEntry &entry = pageTable[first + i];
+        if (!entry.valid || entry.readOnly
+            || (int) entry.physicalPage != firstFrame + (int) i
+            || (pageTable.Flags (first + i) & (PageCopyOnWrite | PageMerged | PageSwapped))
+            || pageprovider->RefCount (entry.physicalPage) != 1)
+            return;
+      }
+
+    pageTable[first].superpage = TRUE;
+    stats->numSuperpagePromotions++;
+    DEBUG ('a', "Promoted pages %d-%d to a superpage at frame %d\n",
+           first, first + SuperPagePages - 1, firstFrame);
+
+    for (element = reservations.FirstElement (); element; element = element->next)
+        if (((SuperpageRun *) element->item)->firstPage == first)
+          {
+            SuperpageRun *run = (SuperpageRun *) element->item;
+            reservations.Remove (run);
+            delete run;
+            break;
+          }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Demote
+//      If page "vpn" is part of a superpage, split it back into single
+//      pages, before one of them gets remapped.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::Demote (unsigned int vpn)
+{
+    unsigned int first = vpn - vpn % SuperPagePages;
+
+    if (!pageTable.Populated (first) || !pageTable[first].superpage)
+        return;
+
+    // only the first entry was kept up to date by the machine
+    for (unsigned int i = 1; i < SuperPagePages; i++)
+      {
+        pageTable[first + i].use |= pageTable[first].use;
+        pageTable[first + i].dirty |= pageTable[first].dirty;
+      }
+    pageTable[first].superpage = FALSE;
+    stats->numSuperpageDemotions++;
+    DEBUG ('a', "Demoted superpage at page %d\n", first);
+#ifdef USE_TLB
+    for (int i = 0; i < TLBSize; i++)
+        if (machine->tlb[i].valid && machine->tlb[i].virtualPage == first)
+            machine->tlb[i].valid = FALSE;
+#endif
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TestUse
+//      Return the use bit of page "vpn", and clear it if "clear".  The
+//      pages of a superpage share the bit of its first entry, which is
+//      cleared with the last one.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::TestUse (unsigned int vpn, bool clear)
+{
+    unsigned int first = vpn - vpn % SuperPagePages;
+    bool used;
+
+    if (pageTable[first].superpage)
+      {
+        used = pageTable[first].use;
+        if (clear && vpn == first + SuperPagePages - 1)
+            pageTable[first].use = FALSE;
+        return used;
+      }
+    used = pageTable[vpn].use;
+    if (clear)
+        pageTable[vpn].use = FALSE;
+    return used;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::IsStackGuard
+//      Return TRUE if "virtAddr" is in the unmapped page just below the
+//      stack region, i.e. the stack has overflowed userStackLimit.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::IsStackGuard (int virtAddr)
+{
+    return (unsigned) virtAddr / PageSize == stackBottom - 1;
+}
+#endif
+
 //----------------------------------------------------------------------
 // AddrSpace::InitRegisters
 //      Set the initial values for the user-level register set.
@@ -202,9 +1295,18 @@ AddrSpace::InitRegisters ()
     // Set the stack register to the end of the address space, where we
     // allocated the stack; but subtract off a bit, to make sure we don't
     // accidentally reference off the end!
+#ifdef CHANGED
+    // The stack region ends below the mappings and the kernel info page
+    machine->WriteRegister (StackReg, stackTop * PageSize - 16);
+    DEBUG ('a', "Initializing stack register to 0x%x\n",
+           stackTop * PageSize - 16);
+    threads->SetMain (currentThread);
+    kernelinfo->Refresh ();
+#else
     machine->WriteRegister (StackReg, numPages * PageSize - 16);
     DEBUG ('a', "Initializing stack register to 0x%x\n",
            numPages * PageSize - 16);
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -240,8 +1342,19 @@ AddrSpace::Dump(FILE *output, unsigned addr_x, unsigned sections_x, unsigned vir
                 unsigned physical_x, unsigned virtual_y, unsigned y,
                 unsigned blocksize)
 {
+#ifdef CHANGED
+    // a two-level table is dumped through a flat copy
+    TranslationEntry *flat = pageTable.FlatEntries ();
+    if (flat == NULL)
+        flat = pageTable.Flatten ();
+    unsigned ret = machine->DumpPageTable(output, flat, numPages,
+            addr_x, virtual_x, virtual_width, physical_x, virtual_y, y, blocksize);
+    if (flat != pageTable.FlatEntries ())
+        delete [] flat;
+#else
     unsigned ret = machine->DumpPageTable(output, pageTable, numPages,
             addr_x, virtual_x, virtual_width, physical_x, virtual_y, y, blocksize);
+#endif
 
     DrawArea(output, sections_x, virtual_x, virtual_y, blocksize, &noffH.code, "code");
     DrawArea(output, sections_x, virtual_x, virtual_y, blocksize, &noffH.initData, "data");
@@ -319,6 +1432,10 @@ AddrSpace::SaveState ()
 void
 AddrSpace::RestoreState ()
 {
+#ifdef CHANGED
+    pageTable.Install ();
+#else
     machine->currentPageTable = pageTable;
     machine->currentPageTableSize = numPages;
+#endif
 }
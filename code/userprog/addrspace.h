@@ -19,7 +19,52 @@
 #include "noff.h"
 #include "list.h"
 
+#ifdef CHANGED
+#include "pagetable.h"
+
+#define UserStacksAreaSize		8192	// default size of the stack
+						// region, see -sl.  Only the
+						// pages actually used get backed.
+#define UserHeapAreaSize		65536	// default size of the heap
+						// region, see -hl.  Only the
+						// pages below the break get backed.
+#define StackGrowthSlack		PageSize	// how far below the stack
+						// pointer a fault still grows
+						// the stack
+#define WorkingSetWindow		4	// samples a page stays in the
+						// working set after its last use
+						// (at most 8, see PageTable::History)
+#else
 #define UserStacksAreaSize		1024	// increase this as necessary!
+#endif
+
+#ifdef CHANGED
+// Software page state, kept in PageTable::Flags alongside the
+// hardware page table entry of the same page
+#define PageCopyOnWrite		0x1	// read-only mapping of a shared frame,
+					// to be copied on the first write
+#define PageMerged		0x2	// shared after being found identical
+					// to another page, see ksm.h
+#define PageSwapped		0x4	// swapped out, physicalPage is the
+					// swap slot, see swap.h
+#define PageReferenced		0x8	// use bit seen set by the page
+					// replacement clock since the last
+					// working set sample
+
+extern unsigned int userStackLimit;	// Size of the stack region
+extern unsigned int userHeapLimit;	// Size of the heap region
+
+class TextImage;
+class StartupProfile;
+class Mapping;
+class SyscallRing;
+class FileDescriptors;
+class AioQueue;
+class UserThreads;
+class Lock;
+
+extern bool superpages;			// Reserve frames for superpages
+#endif
 
 class AddrSpace:public dontcopythis
 {
@@ -41,13 +86,145 @@ class AddrSpace:public dontcopythis
                                 // Dump program layout as SVG
     unsigned NumPages(void) { return numPages; }
 
+#ifdef CHANGED
+    bool CopyOnWrite (int virtAddr); // Resolve a write to a copy-on-write
+                                // page.  Return FALSE if "virtAddr" is
+                                // really read-only.
+    bool GrowStack (int virtAddr, int stackPointer);
+                                // Back the stack down to "virtAddr", if
+                                // this is a legitimate stack growth
+    bool IsStackGuard (int virtAddr); // Is "virtAddr" just below the
+                                // stack region?
+
+    int PrivateFrame (unsigned int vpn); // Frame of page "vpn" if it is
+                                // private and writable, else -1
+    bool MapsFrame (unsigned int vpn, int frame);
+                                // Is page "vpn" mapped to "frame"?
+    void MergePage (unsigned int vpn, int frame); // Map page "vpn" copy-
+                                // on-write to identical "frame"
+
+    bool TestAndClearUse (unsigned int vpn); // Was page "vpn" used since
+                                // the last call?
+    void PageOut (unsigned int vpn, int slot); // Page "vpn" is now saved
+                                // in swap "slot"
+    bool PageIn (int virtAddr); // Bring back the page of "virtAddr" if
+                                // it is swapped out
+
+    int SampleWorkingSet (void); // Record and clear use bits, and return
+                                // the working set size in pages
+    int WorkingSet (void)       // As of the last sample
+    {
+        return workingSet;
+    }
+    int PeakWorkingSet (void)
+    {
+        return peakWorkingSet;
+    }
+
+    void Prefetch (StartupProfile * profile); // Back the pages of
+                                // "profile" now, and record first
+                                // touches into it
+    bool PrefetchPage (unsigned int vpn); // Back page "vpn" if it would
+                                // fault on first touch, and if a frame
+                                // is free
+    void SaveProfile (void);    // Save the startup profile, if any
+
+    int Mmap (int id, int offset, int length, int flags);
+                                // Map part of open file "id", return its
+                                // address or 0
+    int Munmap (int virtAddr);  // Remove the mapping at "virtAddr"
+    void UnmapAll (void);       // Remove every mapping
+    bool MapIn (int virtAddr);  // Read in the mapped page of "virtAddr"
+
+    int Sbrk (int increment);   // Move the break, return the old one or -1
+    bool HeapIn (int virtAddr); // Back the heap page of "virtAddr"
+
+    bool ResolveFault (ExceptionType which, int virtAddr, int stackPointer);
+                                // Back "virtAddr" after exception
+                                // "which", or return FALSE
+    bool FaultOutOfFrames (void) // Did the last ResolveFault fail for
+    {                           // want of a frame?
+        return outOfFrames;
+    }
+
+    int SetupRing (int ringAddr, int flags); // Use the syscall ring at
+                                // "ringAddr", see RingSetup
+    SyscallRing *GetRing (void) // The syscall ring, or NULL
+    {
+        return ring;
+    }
+    FileDescriptors *Files (void) // The open files
+    {
+        return files;
+    }
+    AioQueue *GetAio (bool start); // The asynchronous I/O queue, started
+                                // if "start", else NULL if there is none
+    UserThreads *Threads (void) // The threads of the program
+    {
+        return threads;
+    }
+#endif
+
   private:
     NoffHeader noffH;           // Program layout
 
+#ifdef CHANGED
+    PageTable pageTable;        // Page table, with the software state
+                                // (pageTable.Flags) and use history
+                                // (pageTable.History) of each page
+#else
     TranslationEntry * pageTable; // Page table
+#endif
     unsigned int numPages;      // Number of pages in the page table
+#ifdef CHANGED
+    unsigned int stackBottom;   // Lowest page the stack may grow to
+    TextImage *text;            // Shared code pages, or NULL
+    int workingSet, peakWorkingSet; // Pages used within the window
+    StartupProfile *profile;    // Startup pages of the program, or NULL
+    unsigned int stackTop;      // First page past the stack region,
+                                // where file mappings go
+    List mappings;              // Mappings of files
+    unsigned int heapBottom;    // First page of the heap region, among
+                                // the mappings
+    unsigned int heapPages;     // Size of the heap region, 0 until the
+                                // first Sbrk
+    int heapBreak;              // End of the heap
+    SyscallRing *ring;          // Syscall ring, or NULL
+    FileDescriptors *files;     // Open files
+    AioQueue *aio;              // Asynchronous I/O queue, or NULL
+    UserThreads *threads;       // Threads running the program
+    Lock *faultLock;            // Threads resolve their faults one at a
+                                // time
+    bool outOfFrames;           // The last fault found no frame free
+
+    struct SuperpageRun         // frames reserved for a superpage
+    {
+        unsigned int firstPage;
+        int firstFrame;
+    };
+    List reservations;          // SuperpageRuns not promoted yet
+
+    int AllocFrame (unsigned int vpn); // New frame for page "vpn"
+    bool SuperpageCandidate (unsigned int first);
+    void TryPromote (unsigned int vpn);
+    void Demote (unsigned int vpn);
+    bool TestUse (unsigned int vpn, bool clear);
+
+    Mapping *FindMapping (unsigned int vpn);
+    unsigned int FindMapRange (unsigned int count);
+    void Unmap (Mapping * mapping);
+    void FreePage (unsigned int vpn);
+    bool InHeap (unsigned int vpn)
+    {
+        return vpn >= heapBottom && vpn < heapBottom + heapPages;
+    }
+#endif
 };
 
 extern List AddrspaceList;
+#ifdef CHANGED
+extern List AddrSpaceList;      // All address spaces
+extern bool IsAddrSpace (AddrSpace * space); // Is "space" in the list?
+#endif
 
 #endif // ADDRSPACE_H
@@ -0,0 +1,202 @@
+#ifdef CHANGED
+
+// aio.cc
+//      Routines to run the asynchronous file requests of a process.
+
+#include "copyright.h"
+#include "system.h"
+#include "syscall.h"
+#include "aio.h"
+#include "synch.h"
+#include <stddef.h>
+
+//----------------------------------------------------------------------
+// AioServer
+//      Entry point of the I/O thread of "arg", an AioQueue.
+//----------------------------------------------------------------------
+
+static void
+AioServer (void *arg)
+{
+    ((AioQueue *) arg)->Serve ();
+}
+
+//----------------------------------------------------------------------
+// AioQueue::AioQueue
+//      Start an I/O thread running in "space", with nothing to do yet.
+//----------------------------------------------------------------------
+
+AioQueue::AioQueue (AddrSpace * space)
+{
+    running = 0;
+    stopping = FALSE;
+    lock = new Lock ("aio");
+    queued = new Condition ("aio queued");
+    completed = new Condition ("aio completed");
+    stopped = new Semaphore ("aio stopped", 0);
+
+    Thread *thread = new Thread ("aio");
+    thread->space = space;
+    thread->Start (AioServer, this);
+}
+
+AioQueue::~AioQueue ()
+{
+    ASSERT (stopping && requests.IsEmpty ());
+    delete stopped;
+    delete completed;
+    delete queued;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// AioQueue::Submit
+//      Queue the request described by the AioControl at user address
+//      "control", and mark it pending.  Then let the I/O thread start
+//      it: it gives the CPU back as soon as it waits for the disk.
+//
+//      Return -1 if "control" cannot be read or written.
+//----------------------------------------------------------------------
+
+int
+AioQueue::Submit (int control, bool reading)
+{
+    AioControl copy;
+
+    if (!copyIn (control, &copy, sizeof (copy)))
+        return -1;
+
+    Request *request = new Request;
+    request->control = control;
+    request->reading = reading;
+    request->id = WordToHost (copy.id);
+    request->buffer = WordToHost (copy.buffer);
+    request->size = WordToHost (copy.size);
+    request->offset = WordToHost (copy.offset);
+
+    int status = WordToMachine (AIO_PENDING);
+    if (!copyOut (&status, control + offsetof (AioControl, status), sizeof (status)))
+      {
+        delete request;
+        return -1;
+      }
+
+    lock->Acquire ();
+    requests.Append (request);
+    queued->Signal (lock);
+    lock->Release ();
+    stats->numAioRequests++;
+
+    currentThread->Yield ();
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// AioQueue::Wait
+//      Wait until the request at "control" is neither queued nor
+//      running, and return its status, or -1 if it was never queued.
+//----------------------------------------------------------------------
+
+int
+AioQueue::Wait (int control)
+{
+    int status;
+
+    lock->Acquire ();
+    if (Pending (control))
+        stats->numAioWaitsBlocked++;
+    while (Pending (control))
+        completed->Wait (lock);
+    lock->Release ();
+
+    if (!copyIn (control + offsetof (AioControl, status), &status, sizeof (status)))
+        return -1;
+    status = WordToHost (status);
+    return status == AIO_PENDING ? -1 : status;
+}
+
+//----------------------------------------------------------------------
+// AioQueue::Stop
+//      Wait for the I/O thread to run the queued requests and finish.
+//----------------------------------------------------------------------
+
+void
+AioQueue::Stop ()
+{
+    lock->Acquire ();
+    stopping = TRUE;
+    queued->Signal (lock);
+    lock->Release ();
+    stopped->P ();
+}
+
+//----------------------------------------------------------------------
+// AioQueue::Serve
+//      Run the requests as they get queued, until stopped.
+//----------------------------------------------------------------------
+
+void
+AioQueue::Serve ()
+{
+    lock->Acquire ();
+    for (;;)
+      {
+        while (requests.IsEmpty () && !stopping)
+            queued->Wait (lock);
+        if (requests.IsEmpty ())
+            break;
+
+        Request *request = (Request *) requests.Remove ();
+        running = request->control;
+        lock->Release ();
+
+        FileDescriptors *files = currentThread->space->Files ();
+        int status = request->reading
+            ? files->ReadAt (request->id, request->buffer, request->size,
+                             request->offset)
+            : files->WriteAt (request->id, request->buffer, request->size,
+                              request->offset);
+        DEBUG ('f', "Asynchronous %s of %d bytes of file %d: %d\n",
+               request->reading ? "read" : "write", request->size,
+               request->id, status);
+        SetStatus (request->control, status);
+
+        lock->Acquire ();
+        running = 0;
+        delete request;
+        completed->Broadcast (lock);
+      }
+    lock->Release ();
+    stopped->V ();
+}
+
+//----------------------------------------------------------------------
+// AioQueue::Pending
+//      Is the request at "control" queued or running?  The caller holds
+//      the lock.
+//----------------------------------------------------------------------
+
+bool
+AioQueue::Pending (int control)
+{
+    if (running == control)
+        return TRUE;
+    for (ListElement *element = requests.FirstElement (); element; element = element->next)
+        if (((Request *) element->item)->control == control)
+            return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// AioQueue::SetStatus
+//      Publish "status" in the AioControl at "control".
+//----------------------------------------------------------------------
+
+void
+AioQueue::SetStatus (int control, int status)
+{
+    status = WordToMachine (status);
+    (void) copyOut (&status, control + offsetof (AioControl, status), sizeof (status));
+}
+
+#endif // CHANGED
@@ -0,0 +1,65 @@
+#ifdef CHANGED
+
+// aio.h
+//      Asynchronous file I/O for user programs.
+//
+//      AioRead and AioWrite queue a request, described by an AioControl
+//      (see syscall.h) in user memory, and return right away.  A kernel
+//      thread in the address space of the process runs the requests in
+//      order, and writes the result of each one in its status word, which
+//      the program can poll, or wait for with AioWait.
+//
+//      The thread is started on the first request of the process, and
+//      finishes the queued requests before the process exits.
+
+#ifndef AIO_H
+#define AIO_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+
+class AddrSpace;
+class Thread;
+class Lock;
+class Condition;
+class Semaphore;
+
+class AioQueue:public dontcopythis
+{
+  public:
+    AioQueue (AddrSpace * space); // Start the I/O thread of "space"
+    ~AioQueue ();
+
+    int Submit (int control, bool reading); // Queue the request at user
+                                // address "control".  Return 0, or -1.
+    int Wait (int control);     // Wait for it to complete, and return its
+                                // status
+    void Stop (void);           // Run the queued requests, then stop the
+                                // I/O thread
+    void Serve (void);          // Body of the I/O thread
+
+  private:
+    struct Request
+    {
+        int control;            // user address of the AioControl
+        bool reading;
+        int id, buffer, size, offset;
+    };
+
+    bool Pending (int control); // Is the request at "control" queued or
+                                // running?
+    void SetStatus (int control, int status);
+
+    List requests;              // Requests not started yet
+    int running;                // control of the request being run, or 0
+    bool stopping;
+    Lock *lock;                 // protects all of the above
+    Condition *queued;          // signaled when a request is queued
+    Condition *completed;       // broadcast when a request completes
+    Semaphore *stopped;
+};
+
+#endif // AIO_H
+
+#endif // CHANGED
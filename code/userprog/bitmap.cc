@@ -99,6 +99,21 @@ BitMap::Test (int which)
 int
 BitMap::Find ()
 {
+#ifdef CHANGED
+    // Skip the words with every bit set, then take the lowest clear bit
+    // of the first other one.
+    for (int w = 0; w < numWords; w++)
+        if (map[w] != ~0U)
+          {
+              int i = w * BitsInWord + __builtin_ctz (~map[w]);
+
+              if (i >= numBits)
+                  break;
+              Mark (i);
+              return i;
+          }
+    return -1;
+#else
     for (int i = 0; i < numBits; i++)
         if (!Test (i))
           {
@@ -106,7 +121,35 @@ BitMap::Find ()
               return i;
           }
     return -1;
+#endif
+}
+
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// BitMap::FindLast
+//      Like Find, but return the number of the last bit which is clear.
+//----------------------------------------------------------------------
+
+int
+BitMap::FindLast ()
+{
+    for (int w = numWords - 1; w >= 0; w--)
+      {
+          unsigned int clear = ~map[w];
+
+          if (w == numWords - 1 && numBits % BitsInWord != 0)
+              clear &= (1U << numBits % BitsInWord) - 1;    // past numBits
+          if (clear != 0)
+            {
+                int i = w * BitsInWord + BitsInWord - 1 - __builtin_clz (clear);
+
+                Mark (i);
+                return i;
+            }
+      }
+    return -1;
 }
+#endif
 
 //----------------------------------------------------------------------
 // BitMap::NumClear
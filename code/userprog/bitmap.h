@@ -40,6 +40,9 @@ class BitMap:public dontcopythis
     int Find (void);            // Return the # of a clear bit, and as a side
     // effect, set the bit.
     // If no bits are clear, return -1.
+#ifdef CHANGED
+    int FindLast (void);        // Same, taking the highest clear bit
+#endif
     int NumClear (void);        // Return the number of clear bits
 
     void Print (void);          // Print contents of bitmap
@@ -5,58 +5,214 @@
 #include "consoledriver.h"
 #include "synch.h"
 
-static Semaphore *readAvail;
-static Semaphore *writeDone;
+static Semaphore *readMutex;    // one reader at a time, now that several
+static Semaphore *writeMutex;   // processes share the console
 
 static void ReadAvailHandler(void *arg)
 {
-    (void)arg;
-    readAvail->V();
+    ((ConsoleDriver *) arg)->ReadAvail();
 }
 
 static void WriteDoneHandler(void *arg)
 {
-    (void)arg;
-    writeDone->V();
+    ((ConsoleDriver *) arg)->WriteDone();
 }
 
 ConsoleDriver::ConsoleDriver(const char *in, const char *out)
 {
-    readAvail = new Semaphore("read avail", 0);
-    writeDone = new Semaphore("write done", 0);
-    console = new Console(in, out, ReadAvailHandler, WriteDoneHandler, NULL);
+    readMutex = new Semaphore("console read", 1);
+    writeMutex = new Semaphore("console write", 1);
+    writeRoom = new Semaphore("console write room", 0);
+    drained = new Semaphore("console drained", 0);
+    outHead = outCount = 0;
+    sending = waitingForRoom = waitingForDrain = FALSE;
+    lineReady = new Semaphore("console line ready", 0);
+    inHead = inCount = inReady = 0;
+    inputEnd = inputHeld = waitingForLine = FALSE;
+    console = new Console(in, out, ReadAvailHandler, WriteDoneHandler, this);
 }
 
 ConsoleDriver::~ConsoleDriver()
 {
     delete console;
-    delete writeDone;
-    delete readAvail;
+    delete lineReady;
+    delete drained;
+    delete writeRoom;
+    delete writeMutex;
+    delete readMutex;
 }
 
 void ConsoleDriver::PutChar(int ch)
 {
-    console->TX(ch);
-    writeDone->P (); 
-} 
+    char c = ch;
+
+    writeMutex->P();
+    Queue(&c, 1);
+    writeMutex->V();
+}
 
 int ConsoleDriver::GetChar()
 {
-    readAvail->P();
-    return console->RX();
+    char c;
+
+    if (Read(&c, 1) == 0)
+        return EOF;
+    return (unsigned char) c;
 }
 
 void ConsoleDriver::PutString(const char *s)
 {
-    int i = 0;
-    while(s[i] != '\0') {
-        PutChar(s[i++]);
-    }
+    Write(s, strlen(s));
 }
 
 void ConsoleDriver::GetString(char *s, int n)
 {
-    // ...
+    if (n <= 0)
+        return;
+    s[Read(s, n - 1)] = '\0';
+}
+
+void ConsoleDriver::Write(const char *s, int n)
+{
+    writeMutex->P();
+    Queue(s, n);
+    writeMutex->V();
+}
+
+// Wait for a complete line, and take at most "n" characters of it.  The
+// rest of the line is left for the next call.  Return 0 once for each
+// end of input.
+int ConsoleDriver::Read(char *s, int n)
+{
+    int count = 0;
+
+    if (n <= 0)
+        return 0;
+
+    readMutex->P();
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    while (inReady == 0 && !inputEnd) {
+        waitingForLine = TRUE;
+        lineReady->P();
+    }
+
+    while (count < n && inReady > 0) {
+        char c = inBuffer[inHead];
+        inHead = (inHead + 1) % ConsoleBufferSize;
+        inCount--;
+        inReady--;
+        s[count++] = c;
+        if (c == '\n')
+            break;
+    }
+    if (count == 0)
+        inputEnd = FALSE;       // reported
+
+    if (inputHeld) {
+        inputHeld = FALSE;
+        Receive(console->RX());
+    }
+    (void) interrupt->SetLevel(oldLevel);
+    readMutex->V();
+    return count;
+}
+
+// Wait until every queued character has been written.
+void ConsoleDriver::Flush()
+{
+    if (!sending)
+        return;                 // nothing queued, and no writer blocked
+
+    writeMutex->P();
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    if (sending) {
+        waitingForDrain = TRUE;
+        drained->P();
+    }
+    (void) interrupt->SetLevel(oldLevel);
+    writeMutex->V();
+}
+
+// Queue "n" characters of "s" for output, starting the console if it is
+// idle.  Only block while the queue is full.  The caller holds writeMutex.
+void ConsoleDriver::Queue(const char *s, int n)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    for (int i = 0; i < n; i++) {
+        if (!sending) {
+            sending = TRUE;
+            console->TX(s[i]);
+            continue;
+        }
+        while (outCount == ConsoleBufferSize) {
+            waitingForRoom = TRUE;
+            writeRoom->P();
+        }
+        outBuffer[(outHead + outCount) % ConsoleBufferSize] = s[i];
+        outCount++;
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+// Called from the write done interrupt: send the next queued character,
+// and wake up whoever waits for room or for the queue to drain.
+void ConsoleDriver::WriteDone()
+{
+    if (outCount == 0) {
+        sending = FALSE;
+        if (waitingForDrain) {
+            waitingForDrain = FALSE;
+            drained->V();
+        }
+        return;
+    }
+
+    char ch = outBuffer[outHead];
+    outHead = (outHead + 1) % ConsoleBufferSize;
+    outCount--;
+    console->TX(ch);
+    if (waitingForRoom) {
+        waitingForRoom = FALSE;
+        writeRoom->V();
+    }
+}
+
+// Called from the read avail interrupt.  When the input buffer is full,
+// leave the character in the console: it stops polling until Read makes
+// room and takes it.
+void ConsoleDriver::ReadAvail()
+{
+    if (inCount == ConsoleBufferSize) {
+        inputHeld = TRUE;
+        return;
+    }
+    Receive(console->RX());
+}
+
+// Line discipline: backspace and delete erase the last character of the
+// line being typed, and a newline, the end of input or a full buffer hand
+// the line over to readers.
+void ConsoleDriver::Receive(int ch)
+{
+    if (ch == EOF) {
+        inputEnd = TRUE;
+        inReady = inCount;
+    } else if (ch == '\b' || ch == 0x7f) {
+        if (inCount > inReady)
+            inCount--;
+        return;
+    } else {
+        inBuffer[(inHead + inCount) % ConsoleBufferSize] = ch;
+        inCount++;
+        if (ch != '\n' && inCount < ConsoleBufferSize)
+            return;
+        inReady = inCount;
+    }
+
+    if (waitingForLine) {
+        waitingForLine = FALSE;
+        lineReady->V();
+    }
 }
 
 #endif // CHANGED
\ No newline at end of file
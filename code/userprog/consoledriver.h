@@ -7,6 +7,11 @@
 #include "utility.h"
 #include "console.h"
 
+#define ConsoleBufferSize	256	// characters queued for output, and
+					// input characters buffered
+
+class Semaphore;
+
 class ConsoleDriver : dontcopythis
 {
 public:
@@ -17,8 +22,42 @@ public:
     int GetChar();                  // Behaves like getchar(3S)
     void PutString(const char *s);  // Behaves like fputs(3S)
     void GetString(char *s, int n); // Behaves like fgets(3S)
+    void Write(const char *s, int n); // Write "n" characters of "s"
+    int Read(char *s, int n);       // Read at most "n" characters of one
+                                    // line, return how many, 0 at end of
+                                    // input
+    void Flush();                   // Wait until all output is written
+
+    void ReadAvail();               // Take in the received character
+    void WriteDone();               // Send the next queued character
 private:
     Console *console;
+
+    // Output is queued here, and sent one character per WriteDone
+    // interrupt, so that writers only block when the queue is full.
+    char outBuffer[ConsoleBufferSize];
+    int outHead;                    // next character to send
+    int outCount;                   // characters queued
+    bool sending;                   // is a character being sent?
+    bool waitingForRoom;            // is a writer waiting on writeRoom?
+    bool waitingForDrain;           // is Flush waiting on drained?
+    Semaphore *writeRoom;
+    Semaphore *drained;
+
+    // Input is assembled into lines here by the ReadAvail interrupt.
+    // Readers only see complete lines: the first inReady characters.
+    char inBuffer[ConsoleBufferSize];
+    int inHead;                     // next character to read
+    int inCount;                    // characters buffered
+    int inReady;                    // characters of complete lines
+    bool inputEnd;                  // end of input reached
+    bool inputHeld;                 // is a character left in the console
+                                    // until there is room for it?
+    bool waitingForLine;            // is a reader waiting on lineReady?
+    Semaphore *lineReady;
+
+    void Queue(const char *s, int n); // Queue "n" characters of "s"
+    void Receive(int ch);           // Add "ch" to the line being typed
 };
 
 #endif // CONSOLEDRIVER_H
@@ -26,6 +26,10 @@
 #include "copyright.h"
 #include "system.h"
 #include "syscall.h"
+#ifdef CHANGED
+#include "exception.h"
+#include <ctype.h>
+#endif
 
 //----------------------------------------------------------------------
 // UpdatePC : Increments the Program Counter register in order to resume
@@ -43,6 +47,579 @@ UpdatePC ()
 }
 
 
+#ifdef CHANGED
+//----------------------------------------------------------------------
+// straceSyscalls
+//      Whether every system call gets logged, see -strace.
+//----------------------------------------------------------------------
+
+bool straceSyscalls = FALSE;
+
+//----------------------------------------------------------------------
+// SysPutString
+//      Write the string at user address "from" to the console.  A bad
+//      address just ends the string.
+//----------------------------------------------------------------------
+
+static void
+SysPutString (int from)
+{
+    char str[MAX_STRING_SIZE];
+    int copied;
+
+    // Considers the '\0' character
+    while ((copied = copyInString (from, str, MAX_STRING_SIZE)) > 0)
+      {
+        consoledriver->PutString (str);
+        if (copied < MAX_STRING_SIZE - 1)
+            break;
+        from += copied;
+      }
+}
+
+//----------------------------------------------------------------------
+// SysRead
+//      Read at most "size" bytes of open file "id" to user address "to".
+//      Return how many bytes were read, or -1.  ConsoleInput is the
+//      console, unless ExecWith put a descriptor in its place.
+//----------------------------------------------------------------------
+
+static int
+SysRead (int to, int size, int id)
+{
+    char buffer[ConsoleBufferSize];
+    int result;
+
+    if (id != ConsoleInput || currentThread->space->Files ()->IsOpen (id))
+        return currentThread->space->Files ()->Read (id, to, size);
+    if (size < 0)
+        return -1;
+    if (size > ConsoleBufferSize)
+        size = ConsoleBufferSize;
+    result = consoledriver->Read (buffer, size);
+    if (!copyOut (buffer, to, result))
+        return -1;
+    return result;
+}
+
+//----------------------------------------------------------------------
+// SysWrite
+//      Write "size" bytes from user address "from" to open file "id".
+//----------------------------------------------------------------------
+
+static void
+SysWrite (int from, int size, int id)
+{
+    char buffer[MAX_STRING_SIZE];
+
+    if (id != ConsoleOutput || currentThread->space->Files ()->IsOpen (id))
+      {
+        currentThread->space->Files ()->Write (id, from, size);
+        return;
+      }
+    while (size > 0)
+      {
+        int chunk = size < MAX_STRING_SIZE ? size : MAX_STRING_SIZE;
+        if (!copyIn (from, buffer, chunk))
+            break;
+        consoledriver->Write (buffer, chunk);
+        from += chunk;
+        size -= chunk;
+      }
+}
+
+//----------------------------------------------------------------------
+// System call handlers
+//      Each one gets the arguments of the call (r4 to r7 for a trap), and
+//      returns its result, which goes to r2 if the call has one.
+//----------------------------------------------------------------------
+
+static int
+DoHalt (const int *)
+{
+    DEBUG ('s', "Shutdown, initiated by user program.\n");
+    currentThread->space->SaveProfile ();
+    for (ListElement *e = AddrSpaceList.FirstElement (); e; e = e->next)
+        ((AddrSpace *) e->item)->UnmapAll ();
+    consoledriver->Flush ();
+    interrupt->Powerdown ();
+    return 0;
+}
+
+static int
+DoExit (const int *args)
+{
+    DEBUG ('s', "Shutdown, exited the program with code %d\n", args[0]);
+    ExitProcess (args[0]);
+}
+
+static int
+DoExec (const int *args)
+{
+    char name[MAX_FILENAME_SIZE];
+
+    if (copyInString (args[0], name, MAX_FILENAME_SIZE) < 0)
+        return -1;
+    return ExecProcess (name, ConsoleInput, ConsoleOutput);
+}
+
+static int
+DoExecWith (const int *args)
+{
+    char name[MAX_FILENAME_SIZE];
+
+    if (copyInString (args[0], name, MAX_FILENAME_SIZE) < 0)
+        return -1;
+    return ExecProcess (name, args[1], args[2]);
+}
+
+static int
+DoJoin (const int *args)
+{
+    return processTable->Join (args[0]);
+}
+
+static int
+DoCreate (const int *args)
+{
+    char name[MAX_FILENAME_SIZE];
+
+    if (copyInString (args[0], name, MAX_FILENAME_SIZE) < 0
+        || !fileSystem->Create (name, 0))
+        return -1;
+    return 0;
+}
+
+static int
+DoOpen (const int *args)
+{
+    char name[MAX_FILENAME_SIZE];
+
+    if (copyInString (args[0], name, MAX_FILENAME_SIZE) < 0)
+        return -1;
+    return currentThread->space->Files ()->Open (name);
+}
+
+static int
+DoClose (const int *args)
+{
+    return currentThread->space->Files ()->Close (args[0]);
+}
+
+static int
+DoRead (const int *args)
+{
+    return SysRead (args[0], args[1], args[2]);
+}
+
+static int
+DoWrite (const int *args)
+{
+    SysWrite (args[0], args[1], args[2]);
+    return 0;
+}
+
+static int
+DoYield (const int *)
+{
+    currentThread->Yield ();
+    return 0;
+}
+
+static int
+DoPutChar (const int *args)
+{
+    consoledriver->PutChar ((char) args[0]);
+    return 0;
+}
+
+static int
+DoPutString (const int *args)
+{
+    SysPutString (args[0]);
+    return 0;
+}
+
+static int
+DoMmap (const int *args)
+{
+    return currentThread->space->Mmap (args[0], args[1], args[2], args[3]);
+}
+
+static int
+DoMunmap (const int *args)
+{
+    return currentThread->space->Munmap (args[0]);
+}
+
+static int
+DoGetString (const int *args)
+{
+    int size = args[1];
+    char str[ConsoleBufferSize + 1];
+
+    if (size > ConsoleBufferSize + 1)
+        size = ConsoleBufferSize + 1;
+    if (size > 0)
+      {
+        // the whole line goes out in one copy
+        consoledriver->GetString (str, size);
+        if (!copyOut (str, args[0], strlen (str) + 1))
+          {
+            DEBUG ('s', "GetString: bad buffer %x, line lost\n", args[0]);
+            return -1;
+          }
+      }
+    return 0;
+}
+
+static int
+DoRingSetup (const int *args)
+{
+    return currentThread->space->SetupRing (args[0], args[1]);
+}
+
+static int
+DoRingEnter (const int *)
+{
+    SyscallRing *ring = currentThread->space->GetRing ();
+
+    return ring != NULL ? ring->Enter () : -1;
+}
+
+static int
+DoAioRead (const int *args)
+{
+    return currentThread->space->GetAio (TRUE)->Submit (args[0], TRUE);
+}
+
+static int
+DoAioWrite (const int *args)
+{
+    return currentThread->space->GetAio (TRUE)->Submit (args[0], FALSE);
+}
+
+static int
+DoAioWait (const int *args)
+{
+    AioQueue *aio = currentThread->space->GetAio (FALSE);
+
+    return aio != NULL ? aio->Wait (args[0]) : -1;
+}
+
+static int
+DoFutex (const int *args)
+{
+    switch (args[1])
+      {
+        case FUTEX_WAIT:
+          return futextable->Wait (args[0], args[2]);
+        case FUTEX_WAKE:
+          return futextable->Wake (args[0], args[2]);
+        default:
+          return -1;
+      }
+}
+
+static int
+DoThreadCreate (const int *args)
+{
+    if (args[0] == 0)
+        return -1;
+    return currentThread->space->Threads ()->Create (args[2], args[0], args[1]);
+}
+
+static int
+DoThreadExit (const int *args)
+{
+    currentThread->space->Threads ()->Exit (args[0]);
+}
+
+static int
+DoThreadJoin (const int *args)
+{
+    return currentThread->space->Threads ()->Join (args[0]);
+}
+
+static int
+DoSbrk (const int *args)
+{
+    return currentThread->space->Sbrk (args[0]);
+}
+
+static int
+DoPipe (const int *args)
+{
+    FileDescriptors *files = currentThread->space->Files ();
+    int size = args[1] == 0 ? PIPE_SIZE : args[1];
+    int ids[2];
+
+    if (size < 0 || size > PIPE_MAX_SIZE || files->OpenPipe (size, ids) < 0)
+        return -1;
+    for (int end = 0; end < 2; end++)
+        ids[end] = WordToMachine (ids[end]);
+    if (!copyOut (ids, args[0], sizeof (ids)))
+      {
+        files->Close (WordToHost (ids[0]));
+        files->Close (WordToHost (ids[1]));
+        return -1;
+      }
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// syscallTable
+//      Every system call, indexed by its number.  "args" tells how to
+//      print each argument, see PrintArg, and "result" how to print the
+//      result: 'd' or 'x' like an argument, 'v' for none, '?' if the
+//      call does not return.  Calls without a handler are not
+//      implemented.
+//----------------------------------------------------------------------
+
+struct SyscallEntry
+{
+    int number;
+    const char *name;
+    const char *args;
+    char result;
+    int (*handler) (const int *args);
+};
+
+static const SyscallEntry syscallTable[] = {
+    {SC_Halt, "Halt", "", '?', DoHalt},
+    {SC_Exit, "Exit", "d", '?', DoExit},
+    {SC_Exec, "Exec", "s", 'd', DoExec},
+    {SC_Join, "Join", "d", 'd', DoJoin},
+    {SC_Create, "Create", "s", 'd', DoCreate},
+    {SC_Open, "Open", "s", 'd', DoOpen},
+    {SC_Read, "Read", "xdd", 'd', DoRead},
+    {SC_Write, "Write", "xdd", 'v', DoWrite},
+    {SC_Close, "Close", "d", 'd', DoClose},
+    {SC_Fork, "Fork", "x", 'v', NULL},
+    {SC_Yield, "Yield", "", 'v', DoYield},
+    {SC_PutChar, "PutChar", "c", 'v', DoPutChar},
+    {SC_PutString, "PutString", "s", 'v', DoPutString},
+    {SC_Mmap, "Mmap", "dddd", 'x', DoMmap},
+    {SC_Munmap, "Munmap", "x", 'd', DoMunmap},
+    {SC_GetString, "GetString", "xd", 'd', DoGetString},
+    {SC_RingSetup, "RingSetup", "xd", 'd', DoRingSetup},
+    {SC_RingEnter, "RingEnter", "", 'd', DoRingEnter},
+    {SC_AioRead, "AioRead", "x", 'd', DoAioRead},
+    {SC_AioWrite, "AioWrite", "x", 'd', DoAioWrite},
+    {SC_AioWait, "AioWait", "x", 'd', DoAioWait},
+    {SC_Pipe, "Pipe", "xd", 'd', DoPipe},
+    {SC_ExecWith, "ExecWith", "sdd", 'd', DoExecWith},
+    {SC_Futex, "Futex", "xdd", 'd', DoFutex},
+    {SC_ThreadCreate, "ThreadCreate", "xx", 'd', DoThreadCreate},
+    {SC_ThreadExit, "ThreadExit", "d", '?', DoThreadExit},
+    {SC_ThreadJoin, "ThreadJoin", "d", 'd', DoThreadJoin},
+    {SC_Sbrk, "Sbrk", "d", 'x', DoSbrk},
+};
+
+#define NumSyscalls	((int) (sizeof (syscallTable) / sizeof (syscallTable[0])))
+
+// What each system call cost so far
+static struct
+{
+    int calls;
+    long long ticks;            // simulated time from call to return
+    int bytes;                  // copied from or to user memory
+} syscallCounters[NumSyscalls];
+
+//----------------------------------------------------------------------
+// PrintEscaped
+//      Print the "n" characters of "s" to stderr, escaping the
+//      unprintable ones.
+//----------------------------------------------------------------------
+
+static void
+PrintEscaped (const char *s, int n)
+{
+    for (int i = 0; i < n; i++)
+        if (s[i] == '\n')
+            fputs ("\\n", stderr);
+        else if (s[i] == '"' || s[i] == '\\' || s[i] == '\'')
+            fprintf (stderr, "\\%c", s[i]);
+        else if (isprint ((unsigned char) s[i]))
+            fputc (s[i], stderr);
+        else
+            fprintf (stderr, "\\%o", (unsigned char) s[i]);
+}
+
+//----------------------------------------------------------------------
+// PrintArg
+//      Print "value" to stderr, as an integer ('d'), an address ('x'), a
+//      character ('c') or the string at that address ('s').
+//----------------------------------------------------------------------
+
+static void
+PrintArg (char how, int value)
+{
+    char str[StraceStringSize];
+    char c = (char) value;
+    int copied;
+
+    switch (how)
+      {
+        case 'c':
+          fputc ('\'', stderr);
+          PrintEscaped (&c, 1);
+          fputc ('\'', stderr);
+          break;
+        case 's':
+          {
+            // not on behalf of the program, leave the statistics alone
+            int bytes = stats->numBytesCopied;
+            copied = copyInString (value, str, StraceStringSize);
+            stats->numBytesCopied = bytes;
+            if (copied < 0)
+              {
+                fprintf (stderr, "0x%x", value);
+                break;
+              }
+            fputc ('"', stderr);
+            PrintEscaped (str, copied);
+            fputs (copied == StraceStringSize - 1 ? "\"..." : "\"", stderr);
+            break;
+          }
+        case 'x':
+          fprintf (stderr, "0x%x", value);
+          break;
+        default:
+          fprintf (stderr, "%d", value);
+          break;
+      }
+}
+
+//----------------------------------------------------------------------
+// TraceSyscall
+//      Log a call to "entry" with "args" on stderr.  "result" and "ticks"
+//      are what it returned and how long it took, unless the call does
+//      not return.
+//----------------------------------------------------------------------
+
+static void
+TraceSyscall (const SyscallEntry * entry, const int *args, int result,
+              long long ticks)
+{
+    fprintf (stderr, "[%d] %s(", processTable->IdOf (currentThread->space),
+             entry->name);
+    for (int i = 0; entry->args[i] != '\0'; i++)
+      {
+        if (i > 0)
+            fputs (", ", stderr);
+        PrintArg (entry->args[i], args[i]);
+      }
+    fputc (')', stderr);
+    if (entry->result == '?')
+        fputs (" = ?\n", stderr);
+    else
+      {
+        if (entry->result != 'v')
+          {
+            fputs (" = ", stderr);
+            PrintArg (entry->result, result);
+          }
+        fprintf (stderr, " <%lld>\n", ticks);
+      }
+}
+
+//----------------------------------------------------------------------
+// SyscallExists
+//      Is there a handler for system call "number"?
+//----------------------------------------------------------------------
+
+static bool
+SyscallExists (int number)
+{
+    return number >= 0 && number < NumSyscalls
+        && syscallTable[number].handler != NULL;
+}
+
+//----------------------------------------------------------------------
+// DoSyscall
+//      Run system call "number" with "args", and return its result, or
+//      -1 if there is no such call.  Account for the time it takes and
+//      the bytes it copies.
+//----------------------------------------------------------------------
+
+int
+DoSyscall (int number, const int args[4])
+{
+    if (!SyscallExists (number))
+      {
+        DEBUG ('s', "Unimplemented system call %d\n", number);
+        stats->numBadSyscalls++;
+        return -1;
+      }
+
+    const SyscallEntry *entry = &syscallTable[number];
+    long long start = stats->totalTicks;
+    int bytes = stats->numBytesCopied;
+    int result;
+
+    ASSERT (entry->number == number);
+    DEBUG ('s', "%s\n", entry->name);
+    syscallCounters[number].calls++;
+    if (straceSyscalls && entry->result == '?')
+        TraceSyscall (entry, args, 0, 0);
+
+    result = entry->handler (args);
+
+    syscallCounters[number].ticks += stats->totalTicks - start;
+    syscallCounters[number].bytes += stats->numBytesCopied - bytes;
+    if (straceSyscalls)
+        TraceSyscall (entry, args, result, stats->totalTicks - start);
+    return result;
+}
+
+//----------------------------------------------------------------------
+// PrintSyscallStats
+//      Print what each system call cost, the most expensive first.
+//----------------------------------------------------------------------
+
+void
+PrintSyscallStats (void)
+{
+    bool printed[NumSyscalls] = { };
+
+    for (;;)
+      {
+        int worst = -1;
+
+        for (int i = 0; i < NumSyscalls; i++)
+            if (!printed[i] && syscallCounters[i].calls > 0
+                && (worst < 0 || syscallCounters[i].ticks > syscallCounters[worst].ticks))
+                worst = i;
+        if (worst < 0)
+            return;
+
+        printed[worst] = TRUE;
+        printf ("  %s: calls %d, ticks %lld (%lld per call), bytes copied %d\n",
+                syscallTable[worst].name, syscallCounters[worst].calls,
+                syscallCounters[worst].ticks,
+                syscallCounters[worst].ticks / syscallCounters[worst].calls,
+                syscallCounters[worst].bytes);
+      }
+}
+
+//----------------------------------------------------------------------
+// OutOfFrames
+//      No frame was left to back the page of "address": end the current
+//      process only, the others may still fit.
+//----------------------------------------------------------------------
+
+static void
+OutOfFrames (int address)
+{
+    SetColor (stderr, ColorRed);
+    fprintf (stderr, "Out of memory for address %x at PC %x\n",
+             address, machine->registers[PCReg]);
+    ClearColor (stderr);
+    ExitProcess (-1);
+}
+#endif
+
 //----------------------------------------------------------------------
 // ExceptionHandler
 //      Entry point into the Nachos kernel.  Called when a user program
@@ -76,6 +653,16 @@ ExceptionHandler (ExceptionType which)
       {
         case SyscallException:
           {
+#ifdef CHANGED
+            int args[4];
+
+            stats->numSyscallTraps++;
+            for (int i = 0; i < 4; i++)
+                args[i] = machine->ReadRegister (4 + i);
+            int result = DoSyscall (type, args);
+            if (!SyscallExists (type) || syscallTable[type].result != 'v')
+                machine->WriteRegister (2, result);
+#else
             switch (type)
               {
                 case SC_Halt:
@@ -84,44 +671,12 @@ ExceptionHandler (ExceptionType which)
                     interrupt->Powerdown ();
                     break;
                   }
-                #ifdef CHANGED
-                  case SC_Exit:
-                    {
-                      int retval = machine->ReadRegister(4);  // gets return value (?)
-                      char msg[100];
-                      snprintf(msg, sizeof(msg), "Shutdown, exited the program with code %d\n", retval);
-                      DEBUG ('s', msg);
-                      interrupt->Powerdown ();
-                      break;
-                    }
-                  case SC_PutChar:
-                    {
-                      DEBUG ('s', "Putchar\n");
-                      char c_to_put = (char) machine->ReadRegister(4);
-                      consoledriver->PutChar (c_to_put);
-                      break;
-                    }
-                  case SC_PutString:
-                    {
-                      DEBUG ('s', "PutString\n");
-                      int mem_to_copy = machine->ReadRegister(4);  // is it the right register?
-                      char* str = (char*) malloc(MAX_STRING_SIZE);
-                      ASSERT(str != NULL);
-                      // Considers the '\0' character
-                      while(copyStringFromMachine(mem_to_copy, str, MAX_STRING_SIZE) == MAX_STRING_SIZE-1) {
-                        consoledriver->PutString (str);
-                        mem_to_copy += MAX_STRING_SIZE-1;
-                      }
-                      consoledriver->PutString (str);
-                      free(str);
-                      break;
-                    }
-                #endif
                 default:
                   {
                     ASSERT_MSG(FALSE, "Unimplemented system call %d\n", type);
                   }
               }
+#endif
 
             // Do not forget to increment the pc before returning!
             // This skips over the syscall instruction, to continue execution
@@ -133,6 +688,18 @@ ExceptionHandler (ExceptionType which)
         case PageFaultException:
           if (!address) {
             ASSERT_MSG (FALSE, "NULL dereference at PC %x!\n", machine->registers[PCReg]);
+          #ifdef CHANGED
+          } else if (currentThread->space->ResolveFault (which, address, machine->ReadRegister (StackReg))) {
+            break;              // the instruction will be restarted
+          } else if (currentThread->space->FaultOutOfFrames ()) {
+            OutOfFrames (address);
+          } else if (currentThread->space->IsStackGuard (address)) {
+            SetColor (stderr, ColorRed);
+            fprintf (stderr, "Stack overflow at address %x at PC %x (limit %u bytes, see -sl)\n",
+                     address, machine->registers[PCReg], userStackLimit);
+            ClearColor (stderr);
+            ExitProcess (-1);   // only this process, Join sees -1
+          #endif
           } else {
             // For now
             ASSERT_MSG (FALSE, "Page Fault at address %x at PC %x\n", address, machine->registers[PCReg]);
@@ -140,8 +707,20 @@ ExceptionHandler (ExceptionType which)
           break;
 
         case ReadOnlyException:
+          #ifdef CHANGED
+            if (currentThread->space->ResolveFault (which, address, machine->ReadRegister (StackReg)))
+              break;              // the instruction will be restarted
+            if (currentThread->space->FaultOutOfFrames ())
+              OutOfFrames (address);
+            SetColor (stderr, ColorRed);
+            fprintf (stderr, "Read-Only at address %x at PC %x\n",
+                     address, machine->registers[PCReg]);
+            ClearColor (stderr);
+            ExitProcess (-1);   // only this process, Join sees -1
+          #else
           // For now
           ASSERT_MSG (FALSE, "Read-Only at address %x at PC %x\n", address, machine->registers[PCReg]);
+          #endif
           break;
 
         case BusErrorException:
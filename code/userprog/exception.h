@@ -0,0 +1,29 @@
+#ifdef CHANGED
+
+// exception.h
+//      System call dispatch, shared by the exception handler and the
+//      syscall rings.
+//
+//      Every system call goes through a table of handlers (exception.cc),
+//      which counts the calls to each one, the ticks they take and the
+//      bytes they copy from or to user memory.  With -strace, each call is
+//      also logged on stderr, along with its result and ticks.
+
+#ifndef EXCEPTION_H
+#define EXCEPTION_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define StraceStringSize	24	// string arguments get cut to this
+					// length in the log
+
+extern bool straceSyscalls;	// Log every system call, see -strace
+
+extern int DoSyscall (int number, const int args[4]); // Run system call
+				// "number" with "args", return its result
+extern void PrintSyscallStats (void); // Print what each call cost
+
+#endif // EXCEPTION_H
+
+#endif // CHANGED
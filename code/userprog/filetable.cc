@@ -0,0 +1,394 @@
+#ifdef CHANGED
+
+// filetable.cc
+//      Routines to open, read and write files on behalf of user programs.
+
+#include "copyright.h"
+#include "system.h"
+#include "filetable.h"
+#include "pipe.h"
+
+//----------------------------------------------------------------------
+// SharedFile::SharedFile
+//      Record "openFile", whose header is at "headerSector".
+//----------------------------------------------------------------------
+
+SharedFile::SharedFile (OpenFile * openFile, int headerSector)
+{
+    file = openFile;
+    sector = headerSector;
+    users = 0;
+}
+
+SharedFile::~SharedFile ()
+{
+    delete file;
+}
+
+//----------------------------------------------------------------------
+// FileTable::Acquire
+//      Return the open file "name", with one more user.
+//----------------------------------------------------------------------
+
+SharedFile *
+FileTable::Acquire (const char *name)
+{
+    OpenFile *file = fileSystem->Open (name);
+    ListElement *element;
+    SharedFile *shared;
+
+    if (file == NULL)
+        return NULL;
+
+    for (element = files.FirstElement (); element; element = element->next)
+      {
+        shared = (SharedFile *) element->item;
+        if (shared->sector == file->HeaderSector ())
+          {
+            delete file;
+            shared->users++;
+            return shared;
+          }
+      }
+
+    shared = new SharedFile (file, file->HeaderSector ());
+    shared->users = 1;
+    files.Append (shared);
+    DEBUG ('f', "Opening file %s, sector %d\n", name, shared->sector);
+    return shared;
+}
+
+//----------------------------------------------------------------------
+// FileTable::Release
+//      Drop one user of "shared", and close it when the last one is gone.
+//----------------------------------------------------------------------
+
+void
+FileTable::Release (SharedFile * shared)
+{
+    ASSERT (shared->users > 0);
+    if (--shared->users > 0)
+        return;
+
+    DEBUG ('f', "Closing file at sector %d\n", shared->sector);
+    files.Remove (shared);
+    delete shared;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::FileDescriptors
+//      Initialize a table with every descriptor free.
+//----------------------------------------------------------------------
+
+FileDescriptors::FileDescriptors ()
+{
+    for (int i = 0; i < FirstFileId + MaxOpenFiles; i++)
+      {
+        descriptors[i].file = NULL;
+        descriptors[i].pipe = NULL;
+      }
+}
+
+FileDescriptors::~FileDescriptors ()
+{
+    for (int i = 0; i < FirstFileId + MaxOpenFiles; i++)
+        if (IsOpen (i))
+            Release (&descriptors[i]);
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Open
+//      Open "name" at position 0, and return its id, or -1 if it cannot
+//      be opened or every descriptor is taken.
+//----------------------------------------------------------------------
+
+int
+FileDescriptors::Open (const char *name)
+{
+    int id = FreeId ();
+    SharedFile *file;
+
+    if (id < 0 || (file = filetable->Acquire (name)) == NULL)
+        return -1;
+    descriptors[id].file = file;
+    descriptors[id].position = 0;
+    return id;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::OpenPipe
+//      Create a pipe of "size" bytes, and open both of its ends.
+//----------------------------------------------------------------------
+
+int
+FileDescriptors::OpenPipe (int size, int *ids)
+{
+    Pipe *pipe;
+
+    ids[0] = FreeId ();
+    if (ids[0] < 0)
+        return -1;
+    pipe = new Pipe (size);
+    descriptors[ids[0]].pipe = pipe;
+    descriptors[ids[0]].writer = FALSE;
+    pipe->Attach (FALSE);
+
+    ids[1] = FreeId ();
+    if (ids[1] < 0)
+      {
+        Release (&descriptors[ids[0]]);
+        return -1;
+      }
+    descriptors[ids[1]].pipe = pipe;
+    descriptors[ids[1]].writer = TRUE;
+    pipe->Attach (TRUE);
+
+    DEBUG ('f', "Pipe of %d bytes, ids %d and %d\n", size, ids[0], ids[1]);
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Inherit
+//      Make copies of the descriptors "input" and "output" of "parent"
+//      in place of the console.  The console ids of "parent" which are
+//      not redirected stay the console.
+//----------------------------------------------------------------------
+
+bool
+FileDescriptors::Inherit (FileDescriptors * parent, int input, int output)
+{
+    int from[2] = { input, output };
+
+    for (int id = 0; id < FirstFileId; id++)
+        if (!parent->IsOpen (from[id]) && from[id] != id)
+            return FALSE;
+
+    for (int id = 0; id < FirstFileId; id++)
+        if (parent->IsOpen (from[id]))
+            Share (&descriptors[id], parent->Find (from[id]));
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Close
+//      Free descriptor "id".
+//----------------------------------------------------------------------
+
+int
+FileDescriptors::Close (int id)
+{
+    Descriptor *descriptor = Find (id);
+
+    if (descriptor == NULL)
+        return -1;
+    Release (descriptor);
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::IsOpen
+//      Is "id" a file or a pipe end, rather than free, or the console?
+//----------------------------------------------------------------------
+
+bool
+FileDescriptors::IsOpen (int id)
+{
+    return Find (id) != NULL;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Read, FileDescriptors::Write
+//      Move data at the position of descriptor "id", and advance it.
+//----------------------------------------------------------------------
+
+int
+FileDescriptors::Read (int id, int to, int size)
+{
+    Descriptor *descriptor = Find (id);
+    int done;
+
+    if (descriptor == NULL)
+        return -1;
+    if (descriptor->pipe != NULL)
+        return descriptor->writer ? -1 : descriptor->pipe->Read (to, size);
+    done = Transfer (descriptor, to, size, descriptor->position, TRUE);
+    if (done > 0)
+        descriptor->position += done;
+    return done;
+}
+
+int
+FileDescriptors::Write (int id, int from, int size)
+{
+    Descriptor *descriptor = Find (id);
+    int done;
+
+    if (descriptor == NULL)
+        return -1;
+    if (descriptor->pipe != NULL)
+        return descriptor->writer ? descriptor->pipe->Write (from, size) : -1;
+    done = Transfer (descriptor, from, size, descriptor->position, FALSE);
+    if (done > 0)
+        descriptor->position += done;
+    return done;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::ReadAt, FileDescriptors::WriteAt
+//      Move data at "position" in the file of descriptor "id".  Pipes
+//      have no positions.
+//----------------------------------------------------------------------
+
+int
+FileDescriptors::ReadAt (int id, int to, int size, int position)
+{
+    if (position < 0)
+        return -1;
+    return Transfer (Find (id), to, size, position, TRUE);
+}
+
+int
+FileDescriptors::WriteAt (int id, int from, int size, int position)
+{
+    if (position < 0)
+        return -1;
+    return Transfer (Find (id), from, size, position, FALSE);
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::FileOf
+//      Return the file of descriptor "id", or NULL if "id" is not open,
+//      or open on a pipe.
+//----------------------------------------------------------------------
+
+SharedFile *
+FileDescriptors::FileOf (int id)
+{
+    Descriptor *descriptor = Find (id);
+
+    return descriptor != NULL ? descriptor->file : NULL;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Find
+//      Return descriptor "id", or NULL if it is not open.
+//----------------------------------------------------------------------
+
+FileDescriptors::Descriptor *
+FileDescriptors::Find (int id)
+{
+    if (id < 0 || id >= FirstFileId + MaxOpenFiles
+        || (descriptors[id].file == NULL && descriptors[id].pipe == NULL))
+        return NULL;
+    return &descriptors[id];
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::FreeId
+//      Return the lowest free file id past the console, or -1.
+//----------------------------------------------------------------------
+
+int
+FileDescriptors::FreeId ()
+{
+    for (int id = FirstFileId; id < FirstFileId + MaxOpenFiles; id++)
+        if (!IsOpen (id))
+            return id;
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Share
+//      Make "to" one more descriptor on the file or pipe end of "from",
+//      at the same position.
+//----------------------------------------------------------------------
+
+void
+FileDescriptors::Share (Descriptor * to, Descriptor * from)
+{
+    *to = *from;
+    if (to->file != NULL)
+        to->file->users++;
+    else
+        to->pipe->Attach (to->writer);
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Release
+//      Close "descriptor", and its file or pipe if it was the last one
+//      on it.
+//----------------------------------------------------------------------
+
+void
+FileDescriptors::Release (Descriptor * descriptor)
+{
+    if (descriptor->file != NULL)
+        filetable->Release (descriptor->file);
+    else if (descriptor->pipe->Detach (descriptor->writer))
+        delete descriptor->pipe;
+    descriptor->file = NULL;
+    descriptor->pipe = NULL;
+}
+
+//----------------------------------------------------------------------
+// FileDescriptors::Transfer
+//      Move at most "size" bytes between the file of "descriptor", at
+//      "position", and user address "virtAddr": into the user buffer if
+//      "reading", else out of it.  Return how many bytes were moved, or
+//      -1 if "descriptor" is NULL or not on a file, or "virtAddr" is a
+//      bad address.
+//
+//      The data goes straight between the file system and the frames
+//      of the buffer, then between them and the pages of the file
+//      cached for shared mappings, if any.  The file system may block on the disk, so each
+//      run of frames is pinned meanwhile, for swap and KSM to leave it
+//      alone.
+//----------------------------------------------------------------------
+
+int
+FileDescriptors::Transfer (Descriptor * descriptor, int virtAddr, int size,
+                           int position, bool reading)
+{
+    int done = 0;
+
+    if (descriptor == NULL || descriptor->file == NULL || size < 0)
+        return -1;
+
+    while (done < size)
+      {
+        unsigned int span;
+        char *memory = userSpan (virtAddr + done, size - done, reading, &span);
+
+        if (memory == NULL)
+            return done > 0 ? done : -1;
+
+        // Leave the part of the last sector for the next span, unless
+        // the transfer ends there anyway
+        unsigned int partial = (position + done + span) % SectorSize;
+        if (span < (unsigned) (size - done) && span > partial)
+            span -= partial;
+
+        int first = (memory - machine->mainMemory) / PageSize;
+        int last = (memory + span - 1 - machine->mainMemory) / PageSize;
+        for (int frame = first; frame <= last; frame++)
+            pageprovider->ShareFrame (frame); // keep them in place
+
+        OpenFile *file = descriptor->file->file;
+        int moved = reading ? file->ReadAt (memory, span, position + done)
+            : file->WriteAt (memory, span, position + done);
+        if (moved > 0)
+            mapcache->CopyCached (descriptor->file, memory, position + done,
+                                  moved, reading);
+        for (int frame = first; frame <= last; frame++)
+            pageprovider->ReleasePage (frame);
+        if (moved <= 0)
+            break;
+        done += moved;
+        stats->numBytesCopied += moved;
+        if ((unsigned) moved < span)
+            break;              // end of file
+      }
+    return done;
+}
+
+#endif // CHANGED
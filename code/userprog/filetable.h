@@ -0,0 +1,110 @@
+#ifdef CHANGED
+
+// filetable.h
+//      Files opened by user programs.
+//
+//      Each process has its own table of descriptors (FileDescriptors),
+//      with a position in the file for each one.  The descriptors point
+//      into the table of open files shared by all processes (FileTable),
+//      where every file is open only once, however many processes use it
+//      or map it (see mmap.h).
+//      The file ids 0 and 1 are the console (ConsoleInput and
+//      ConsoleOutput), so files get ids from FirstFileId on.  A process
+//      started by ExecWith has a descriptor in place of either one, which
+//      Read and Write use instead of the console.
+//
+//      A descriptor is on a file or on one end of a pipe (see pipe.h).
+//
+//      Read and Write move the data straight between the file and the
+//      frames holding the user buffer, one run of contiguous frames at a
+//      time, without a kernel buffer.  The runs are cut at sector
+//      boundaries of the file, so that whole sectors go through the file
+//      system whenever the buffer allows it.
+
+#ifndef FILETABLE_H
+#define FILETABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+#include "openfile.h"
+
+class Pipe;
+
+#define FirstFileId	2	// after the console
+#define MaxOpenFiles	16	// descriptors per process
+
+// A file open by one or more processes
+class SharedFile:public dontcopythis
+{
+  public:
+    SharedFile (OpenFile * openFile, int headerSector);
+    ~SharedFile ();
+
+    OpenFile *file;
+    int sector;                 // its header sector, which identifies it
+    int users;                  // descriptors on it, and one if it is
+                                // mapped
+};
+
+class FileTable:public dontcopythis
+{
+  public:
+    SharedFile *Acquire (const char *name); // Open "name", or share it if
+                                // it is already open.  NULL if it cannot
+                                // be opened.
+    void Release (SharedFile * shared); // One descriptor on "shared" is
+                                // closed
+
+  private:
+    List files;                 // SharedFiles currently open
+};
+
+class FileDescriptors:public dontcopythis
+{
+  public:
+    FileDescriptors ();
+    ~FileDescriptors ();        // Close the descriptors left open
+
+    int Open (const char *name); // Return a new file id for "name", or -1
+    int OpenPipe (int size, int *ids); // Put the read and write ends of a
+                                // new pipe of "size" bytes in ids[0] and
+                                // ids[1].  Return 0, or -1.
+    bool Inherit (FileDescriptors * parent, int input, int output);
+                                // Use the descriptors "input" and "output"
+                                // of "parent" as console.  FALSE if either
+                                // is not open.
+    bool IsOpen (int id);       // Is there a descriptor "id"?
+    SharedFile *FileOf (int id); // The file of descriptor "id", or NULL if
+                                // it is not open on a file
+    int Close (int id);         // Return 0, or -1 if "id" is not open
+    int Read (int id, int to, int size); // Read "size" bytes at most of
+                                // "id" to user address "to".  Return how
+                                // many were read, or -1.
+    int Write (int id, int from, int size); // Same, from user address
+                                // "from" to "id"
+    int ReadAt (int id, int to, int size, int position); // Same, at
+    int WriteAt (int id, int from, int size, int position); // "position"
+                                // in the file, which stays put
+
+  private:
+    struct Descriptor
+    {
+        SharedFile *file;       // NULL if not on a file
+        Pipe *pipe;             // NULL if not on a pipe; free if neither
+        bool writer;            // on the write end of "pipe"
+        int position;
+    };
+    Descriptor descriptors[FirstFileId + MaxOpenFiles]; // by id
+
+    Descriptor *Find (int id);  // The open descriptor "id", or NULL
+    int FreeId (void);          // A free file id, or -1
+    void Share (Descriptor * to, Descriptor * from); // Make "to" a copy
+    void Release (Descriptor * descriptor); // Free "descriptor"
+    int Transfer (Descriptor * descriptor, int virtAddr, int size,
+                  int position, bool reading);
+};
+
+#endif // FILETABLE_H
+
+#endif // CHANGED
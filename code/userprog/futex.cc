@@ -0,0 +1,105 @@
+#ifdef CHANGED
+
+// futex.cc
+//      Routines to put threads to sleep on words of user memory.
+
+#include "copyright.h"
+#include "system.h"
+#include "futex.h"
+#include "synch.h"
+
+FutexTable::FutexTable ()
+{
+    lock = new Lock ("futexes");
+}
+
+FutexTable::~FutexTable ()
+{
+    ASSERT (waiters.IsEmpty ());
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Wait
+//      Check the word at "virtAddr" and queue the current thread on it,
+//      both under the lock, so that no Wake can come in between.  The
+//      page is made private and writable first, as for a store, so that
+//      no copy on write moves the word while we sleep.
+//----------------------------------------------------------------------
+
+int
+FutexTable::Wait (int virtAddr, int value)
+{
+    Waiter waiter;
+
+    lock->Acquire ();
+    waiter.key = Key (virtAddr, TRUE);
+    if (waiter.key < 0
+        || (int) WordToHost (*(int *) &machine->mainMemory[waiter.key]) != value)
+      {
+        lock->Release ();
+        return -1;
+      }
+    waiter.woken = new Semaphore ("futex", 0);
+    pageprovider->ShareFrame (waiter.key / PageSize); // keep it in place
+    waiters.Append (&waiter);
+    stats->numFutexWaits++;
+    lock->Release ();
+
+    waiter.woken->P ();
+    pageprovider->ReleasePage (waiter.key / PageSize);
+    delete waiter.woken;
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Wake
+//      Wake the oldest "count" waiters on the word at "virtAddr".
+//----------------------------------------------------------------------
+
+int
+FutexTable::Wake (int virtAddr, int count)
+{
+    int woken = 0;
+
+    lock->Acquire ();
+    int key = Key (virtAddr, FALSE);
+    ListElement *element = waiters.FirstElement ();
+
+    while (key >= 0 && element != NULL && woken < count)
+      {
+        Waiter *waiter = (Waiter *) element->item;
+
+        element = element->next;
+        if (waiter->key != key)
+            continue;
+        waiters.Remove (waiter);
+        waiter->woken->V ();
+        woken++;
+      }
+    stats->numFutexWakes += woken;
+    lock->Release ();
+    return key < 0 ? -1 : woken;
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Key
+//      Back the page of "virtAddr" in the current address space, and
+//      return where the word is in mainMemory.
+//----------------------------------------------------------------------
+
+int
+FutexTable::Key (int virtAddr, bool writing)
+{
+    unsigned int span;
+    char *memory;
+
+    if (virtAddr % 4 != 0)
+        return -1;
+    memory = userSpan (virtAddr, 4, writing, &span);
+    if (memory == NULL)
+        return -1;
+    return memory - machine->mainMemory;
+}
+
+#endif // CHANGED
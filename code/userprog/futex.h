@@ -0,0 +1,57 @@
+#ifdef CHANGED
+
+// futex.h
+//      Futexes: wait queues keyed by a word of user memory.
+//
+//      User programs build their locks on words of their own memory, and
+//      only call the kernel when they have to wait (Futex FUTEX_WAIT), or
+//      when someone may be waiting (FUTEX_WAKE).  FUTEX_WAIT sleeps only
+//      if the word still holds the value the caller saw, so a wake-up
+//      between the test in user space and the system call is not lost.
+//
+//      The queues are keyed by the physical address of the word, so that
+//      processes sharing the page (MAP_SHARED) share the futex.  While
+//      someone waits on it, the frame holds one more reference, so that
+//      the page is neither swapped out nor merged, and keeps its key.
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+
+class Lock;
+class Semaphore;
+
+class FutexTable:public dontcopythis
+{
+  public:
+    FutexTable ();
+    ~FutexTable ();
+
+    int Wait (int virtAddr, int value); // Sleep until a Wake on the word
+                                // at "virtAddr", if it holds "value".
+                                // Return 0, or -1 if it does not, or
+                                // "virtAddr" is bad.
+    int Wake (int virtAddr, int count); // Wake at most "count" threads
+                                // sleeping on that word.  Return how
+                                // many, or -1.
+
+  private:
+    struct Waiter
+    {
+        int key;                // physical address of the word
+        Semaphore *woken;
+    };
+
+    int Key (int virtAddr, bool writing); // Physical address of the word,
+                                // or -1 if it is bad or not aligned
+
+    List waiters;               // Waiters, oldest first
+    Lock *lock;                 // protects "waiters"
+};
+
+#endif // FUTEX_H
+
+#endif // CHANGED
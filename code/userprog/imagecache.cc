@@ -0,0 +1,115 @@
+#ifdef CHANGED
+
+// imagecache.cc
+//      Routines to share the code pages of executables.
+
+#include "copyright.h"
+#include "system.h"
+#include "imagecache.h"
+
+//----------------------------------------------------------------------
+// TextImage::TextImage
+//      An image with no frames loaded yet.
+//----------------------------------------------------------------------
+
+TextImage::TextImage (int sec, int first, int num)
+{
+    sector = sec;
+    firstPage = first;
+    numPages = num;
+    frames = new int[numPages];
+    users = 0;
+}
+
+TextImage::~TextImage ()
+{
+    delete [] frames;
+}
+
+//----------------------------------------------------------------------
+// ImageCache::Find
+//      Look up the image of the executable whose header is at "sector".
+//----------------------------------------------------------------------
+
+TextImage *
+ImageCache::Find (int sector)
+{
+    ListElement *element;
+
+    for (element = images.FirstElement (); element; element = element->next)
+      {
+        TextImage *image = (TextImage *) element->item;
+        if (image->sector == sector)
+            return image;
+      }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// ImageCache::Acquire
+//      Return the image of "executable", with one more user.  On a miss,
+//      allocate frames and read the "numPages" code pages starting at
+//      virtual page "firstPage" from offset "inFileAddr" of the file;
+//      return NULL if there are not enough frames.
+//----------------------------------------------------------------------
+
+TextImage *
+ImageCache::Acquire (OpenFile * executable, int firstPage, int numPages,
+                     int inFileAddr)
+{
+    int sector = executable->HeaderSector ();
+    TextImage *image = Find (sector);
+
+    if (image != NULL)
+      {
+        ASSERT (image->firstPage == firstPage && image->numPages == numPages);
+        image->users++;
+        stats->numImageHits++;
+        DEBUG ('a', "Sharing text image of sector %d, %d pages\n",
+               sector, numPages);
+        return image;
+      }
+
+    image = new TextImage (sector, firstPage, numPages);
+    for (int i = 0; i < numPages; i++)
+      {
+        image->frames[i] = pageprovider->GetEmptyPage ();
+        if (image->frames[i] < 0)
+          {
+            while (--i >= 0)
+                pageprovider->ReleasePage (image->frames[i]);
+            delete image;
+            return NULL;
+          }
+        executable->ReadAt (&machine->mainMemory[image->frames[i] * PageSize],
+                            PageSize, inFileAddr + i * PageSize);
+      }
+    image->users = 1;
+    images.Append (image);
+    stats->numImageLoads++;
+    DEBUG ('a', "Loaded text image of sector %d, %d pages\n",
+           sector, numPages);
+    return image;
+}
+
+//----------------------------------------------------------------------
+// ImageCache::Release
+//      Drop one user of "image".  When there is none left, give back
+//      the references the cache holds on its frames and forget it.
+//----------------------------------------------------------------------
+
+void
+ImageCache::Release (TextImage * image)
+{
+    ASSERT (image->users > 0);
+    if (--image->users > 0)
+        return;
+
+    DEBUG ('a', "Dropping text image of sector %d\n", image->sector);
+    for (int i = 0; i < image->numPages; i++)
+        pageprovider->ReleasePage (image->frames[i]);
+    images.Remove (image);
+    delete image;
+}
+
+#endif // CHANGED
@@ -0,0 +1,56 @@
+#ifdef CHANGED
+
+// imagecache.h
+//      Sharing of the code pages of executables between address spaces.
+//
+//      The first address space built from an executable loads its code
+//      pages into frames owned by the cache; every later address space
+//      built from the same file (identified by its header sector) maps
+//      those same frames read-only.  Each mapping takes a reference on
+//      the frames through the PageProvider, and the cache drops its own
+//      references when the last address space using the image is gone.
+//
+//      Only code pages that do not share a page with data can be shared,
+//      see bin/coff2noff, which pads the code segment to a page boundary.
+
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+#include "openfile.h"
+
+class TextImage:public dontcopythis
+{
+  public:
+    TextImage (int sector, int firstPage, int numPages);
+    ~TextImage ();
+
+    int sector;                 // header sector of the executable
+    int firstPage;              // first virtual page of the shared code
+    int numPages;               // number of shared code pages
+    int *frames;                // frame holding each of them
+    int users;                  // address spaces mapping this image
+};
+
+class ImageCache:public dontcopythis
+{
+  public:
+    TextImage *Find (int sector); // Cached image of the executable whose
+                                // header is at "sector", or NULL
+    TextImage *Acquire (OpenFile * executable, int firstPage,
+                        int numPages, int inFileAddr);
+                                // Get the image of "executable", loading
+                                // its code pages from "inFileAddr" if not
+                                // cached.  NULL if memory is exhausted.
+    void Release (TextImage * image); // An address space stops using
+                                // "image"
+
+  private:
+    List images;                // TextImages currently in use
+};
+
+#endif // IMAGECACHE_H
+
+#endif // CHANGED
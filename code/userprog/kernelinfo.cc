@@ -0,0 +1,91 @@
+#ifdef CHANGED
+
+// kernelinfo.cc
+//      Routines to keep the kernel info page up to date.
+
+#include "copyright.h"
+#include "system.h"
+#include "syscall.h"
+#include "kernelinfo.h"
+#include <stddef.h>
+
+//----------------------------------------------------------------------
+// KernelInfoFrame::KernelInfoFrame
+//      Take a frame for the kernel info page, for as long as Nachos runs.
+//----------------------------------------------------------------------
+
+KernelInfoFrame::KernelInfoFrame ()
+{
+    ASSERT (sizeof (KernelInfo) <= PageSize);
+    frame = pageprovider->GetEmptyPage ();
+    ASSERT_MSG (frame >= 0, "No frame for the kernel info page\n");
+    contextSwitches = 0;
+    Tick ();
+    Set (offsetof (KernelInfo, pid), -1);
+}
+
+KernelInfoFrame::~KernelInfoFrame ()
+{
+    pageprovider->ReleasePage (frame);
+}
+
+//----------------------------------------------------------------------
+// KernelInfoFrame::Tick
+//      Called whenever simulated time advances.
+//----------------------------------------------------------------------
+
+void
+KernelInfoFrame::Tick ()
+{
+    Set (offsetof (KernelInfo, totalTicks), (int) stats->totalTicks);
+    Set (offsetof (KernelInfo, userTicks), (int) stats->userTicks);
+    Set (offsetof (KernelInfo, systemTicks), (int) stats->systemTicks);
+    Set (offsetof (KernelInfo, idleTicks), (int) stats->idleTicks);
+}
+
+//----------------------------------------------------------------------
+// KernelInfoFrame::Refresh
+//      Describe currentThread, which is about to run user code.
+//----------------------------------------------------------------------
+
+void
+KernelInfoFrame::Refresh ()
+{
+    int pid = -1;
+
+    if (currentThread->space != NULL)
+        pid = processTable->IdOf (currentThread->space);
+
+    Tick ();
+    Set (offsetof (KernelInfo, pid), pid);
+    Set (offsetof (KernelInfo, readyThreads), scheduler->NumReady ());
+    Set (offsetof (KernelInfo, processes), processTable->NumRunning ());
+    Set (offsetof (KernelInfo, contextSwitches), contextSwitches);
+}
+
+//----------------------------------------------------------------------
+// KernelInfoFrame::Switched
+//      Called when currentThread gets the CPU from another thread.
+//----------------------------------------------------------------------
+
+void
+KernelInfoFrame::Switched ()
+{
+    contextSwitches++;
+    Refresh ();
+}
+
+//----------------------------------------------------------------------
+// KernelInfoFrame::Set
+//      Store the word "value" at "offset" in the page, in the byte order
+//      of the simulated machine.
+//----------------------------------------------------------------------
+
+void
+KernelInfoFrame::Set (int offset, int value)
+{
+    *(int *) &machine->mainMemory[frame * PageSize + offset] =
+        WordToMachine (value);
+}
+
+#endif // CHANGED
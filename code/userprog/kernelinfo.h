@@ -0,0 +1,48 @@
+#ifdef CHANGED
+
+// kernelinfo.h
+//      The kernel info page: a frame holding a KernelInfo (see syscall.h),
+//      mapped read-only at KERNEL_INFO_ADDR in every address space, so
+//      that user programs can read the time, their process id and the
+//      state of the scheduler without a system call.
+//
+//      The tick counters are refreshed on every tick, timer interrupts
+//      included, and the rest on every context switch.  Since only the
+//      running process reads the page, a single frame serves them all.
+
+#ifndef KERNELINFO_H
+#define KERNELINFO_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "machine.h"
+
+#define KernelInfoPage		(KERNEL_INFO_ADDR / PageSize)	// where it
+							// is mapped (needs syscall.h)
+
+class KernelInfoFrame:public dontcopythis
+{
+  public:
+    KernelInfoFrame ();         // Take a frame for the page
+    ~KernelInfoFrame ();
+
+    int Frame (void)            // The frame to map
+    {
+        return frame;
+    }
+
+    void Tick (void);           // Refresh the tick counters
+    void Refresh (void);        // Refresh everything
+    void Switched (void);       // Count a context switch, and refresh
+
+  private:
+    int frame;
+    unsigned int contextSwitches;
+
+    void Set (int offset, int value); // Store "value" at "offset" of
+                                // the KernelInfo
+};
+
+#endif // KERNELINFO_H
+
+#endif // CHANGED
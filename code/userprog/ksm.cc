@@ -0,0 +1,238 @@
+#ifdef CHANGED
+
+// ksm.cc
+//      Routines to merge identical user pages.
+
+#include "copyright.h"
+#include "system.h"
+#include "ksm.h"
+
+//----------------------------------------------------------------------
+// HashFrame
+//      FNV-1a hash of the contents of "frame".
+//----------------------------------------------------------------------
+
+static unsigned int
+HashFrame (int frame)
+{
+    const unsigned char *data =
+        (const unsigned char *) &machine->mainMemory[frame * PageSize];
+    unsigned int hash = 2166136261U;
+
+    for (int i = 0; i < PageSize; i++)
+        hash = (hash ^ data[i]) * 16777619U;
+    return hash;
+}
+
+//----------------------------------------------------------------------
+// SameFrames
+//      Compare the contents of two frames.
+//----------------------------------------------------------------------
+
+static bool
+SameFrames (int frame1, int frame2)
+{
+    stats->numKsmBytesCompared += PageSize;
+    return memcmp (&machine->mainMemory[frame1 * PageSize],
+                   &machine->mainMemory[frame2 * PageSize], PageSize) == 0;
+}
+
+static void
+KsmThread (void *arg)
+{
+    ((Ksm *) arg)->Run ();
+}
+
+// The last wakeup may still be pending when Cleanup deletes the scanner
+static void
+KsmWakeup (void *arg)
+{
+    (void) arg;
+    if (ksm != NULL)
+        ksm->Wakeup ();
+}
+
+//----------------------------------------------------------------------
+// Ksm::Ksm
+//      Set up the scanner, and start its thread.
+//
+//      "pages" is the number of pages to scan at each wakeup
+//      "ticks" is the time to sleep between two wakeups
+//----------------------------------------------------------------------
+
+Ksm::Ksm (int pages, int ticks)
+{
+    pagesToScan = pages;
+    sleepTicks = ticks;
+    wakeup = new Semaphore ("ksm wakeup", 0);
+
+    cursorSpace = NULL;
+    cursorPage = 0;
+
+    candidates = new Candidate[NumPhysPages];
+    numCandidates = 0;
+    lastHash = new unsigned int[NumPhysPages];
+    for (int i = 0; i < NumPhysPages; i++)
+        lastHash[i] = 0;
+    zeroHash = HashFrame (pageprovider->ZeroFrame ());
+
+    Thread *thread = new Thread ("ksm");
+    thread->Start (KsmThread, this);
+    interrupt->Schedule (KsmWakeup, NULL, sleepTicks, TimerInt);
+}
+
+Ksm::~Ksm ()
+{
+    delete [] lastHash;
+    delete [] candidates;
+    delete wakeup;
+}
+
+//----------------------------------------------------------------------
+// Ksm::Run
+//      Wait for a wakeup, scan a batch of pages, and sleep again, as
+//      long as there are user programs.
+//----------------------------------------------------------------------
+
+void
+Ksm::Run (void)
+{
+    for (;;)
+      {
+        wakeup->P ();
+        if (AddrSpaceList.IsEmpty ())
+            break;
+        ScanBatch ();
+        interrupt->Schedule (KsmWakeup, NULL, sleepTicks, TimerInt);
+      }
+}
+
+//----------------------------------------------------------------------
+// Ksm::Wakeup
+//      Called from the interrupt handler: make the scanning thread run
+//      as soon as the interrupt returns.
+//----------------------------------------------------------------------
+
+void
+Ksm::Wakeup (void)
+{
+    wakeup->V ();
+    interrupt->YieldOnReturn ();
+}
+
+//----------------------------------------------------------------------
+// Ksm::NextPage
+//      Move the cursor to the next page, in the next address space at
+//      the end of the current one.  Start a new pass when wrapping
+//      around.
+//----------------------------------------------------------------------
+
+bool
+Ksm::NextPage (void)
+{
+    ListElement *element = AddrSpaceList.FirstElement ();
+
+    if (element == NULL)
+        return FALSE;
+
+    if (cursorSpace != NULL && IsAddrSpace (cursorSpace)
+        && ++cursorPage < cursorSpace->NumPages ())
+        return TRUE;
+
+    if (cursorSpace != NULL && IsAddrSpace (cursorSpace))
+      {
+        // next address space
+        while (element->item != cursorSpace)
+            element = element->next;
+        element = element->next;
+      }
+    else
+        element = NULL;
+
+    if (element == NULL)
+      {
+        // new pass
+        element = AddrSpaceList.FirstElement ();
+        numCandidates = 0;
+        stats->numKsmPasses++;
+      }
+    cursorSpace = (AddrSpace *) element->item;
+    cursorPage = 0;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Ksm::ScanBatch
+//      Scan the next "pagesToScan" pages.
+//----------------------------------------------------------------------
+
+void
+Ksm::ScanBatch (void)
+{
+    for (int i = 0; i < pagesToScan && NextPage (); i++)
+        ScanPage (cursorSpace, cursorPage);
+
+#ifdef USE_TLB
+    // Merged pages became read-only
+    for (int i = 0; i < TLBSize; i++)
+        machine->tlb[i].valid = FALSE;
+#endif
+}
+
+//----------------------------------------------------------------------
+// Ksm::ScanPage
+//      Merge page "vpn" of "space" with an identical page, if it is a
+//      stable candidate and there is one.
+//----------------------------------------------------------------------
+
+void
+Ksm::ScanPage (AddrSpace * space, unsigned int vpn)
+{
+    int frame = space->PrivateFrame (vpn);
+
+    if (frame < 0)
+        return;
+
+    stats->numKsmPagesScanned++;
+    unsigned int hash = HashFrame (frame);
+    bool stable = (hash == lastHash[frame]);
+    lastHash[frame] = hash;
+    if (!stable)
+        return;                 // still being written, try again later
+
+    if (hash == zeroHash && SameFrames (frame, pageprovider->ZeroFrame ()))
+      {
+        DEBUG ('a', "ksm: page %d of %p merged with the zero frame\n", vpn, space);
+        space->MergePage (vpn, pageprovider->ZeroFrame ());
+        stats->numKsmMerged++;
+        return;
+      }
+
+    for (int i = 0; i < numCandidates; i++)
+      {
+        Candidate *c = &candidates[i];
+
+        if (c->hash != hash || c->frame == frame
+            || !IsAddrSpace (c->space) || !c->space->MapsFrame (c->vpn, c->frame)
+            || !SameFrames (c->frame, frame))
+            continue;
+
+        DEBUG ('a', "ksm: page %d of %p merged with page %d of %p, frame %d\n",
+               vpn, space, c->vpn, c->space, c->frame);
+        c->space->MergePage (c->vpn, c->frame);
+        space->MergePage (vpn, c->frame);
+        stats->numKsmMerged++;
+        return;
+      }
+
+    if (numCandidates < NumPhysPages)
+      {
+        Candidate *c = &candidates[numCandidates++];
+        c->hash = hash;
+        c->frame = frame;
+        c->space = space;
+        c->vpn = vpn;
+      }
+}
+
+#endif // CHANGED
@@ -0,0 +1,65 @@
+#ifdef CHANGED
+
+// ksm.h
+//      Kernel same-page merging.
+//
+//      A kernel thread wakes up every "sleepTicks" ticks, and scans
+//      "pagesToScan" user pages, round robin over all address spaces.
+//      Private writable pages whose contents did not change since the
+//      previous time they were scanned are candidates: a candidate
+//      identical to another page seen during the same pass through
+//      memory is remapped to that page's frame, both pages becoming
+//      copy-on-write, and its own frame is freed.  Candidates holding
+//      only zeros are remapped to the shared zero frame.
+//
+//      Pages are found by hashing their contents, then comparing the
+//      frames byte for byte.  A write to a merged page unmerges it
+//      through the usual copy-on-write path, see AddrSpace::CopyOnWrite.
+
+#ifndef KSM_H
+#define KSM_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "synch.h"
+#include "addrspace.h"
+
+class Ksm:public dontcopythis
+{
+  public:
+    Ksm (int pagesToScan, int sleepTicks); // Start the scanning thread
+    ~Ksm ();
+
+    void Run (void);            // Body of the scanning thread
+    void Wakeup (void);         // Called at the end of each sleep
+
+  private:
+    struct Candidate            // page seen during the current pass
+    {
+        unsigned int hash;
+        int frame;
+        AddrSpace *space;
+        unsigned int vpn;
+    };
+
+    void ScanBatch (void);      // Scan the next "pagesToScan" pages
+    bool NextPage (void);       // Advance the cursor, FALSE if there is
+                                // no address space to scan
+    void ScanPage (AddrSpace * space, unsigned int vpn);
+
+    int pagesToScan;
+    int sleepTicks;
+    Semaphore *wakeup;
+
+    AddrSpace *cursorSpace;     // next page to scan
+    unsigned int cursorPage;
+
+    Candidate *candidates;      // pages seen during the current pass
+    int numCandidates;
+    unsigned int *lastHash;     // hash of each frame at its last scan
+    unsigned int zeroHash;      // hash of a page of zeros
+};
+
+#endif // KSM_H
+
+#endif // CHANGED
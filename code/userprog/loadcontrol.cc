@@ -0,0 +1,181 @@
+#ifdef CHANGED
+
+// loadcontrol.cc
+//      Routines to keep the working sets of running processes within
+//      physical memory.
+
+#include "copyright.h"
+#include "system.h"
+#include "loadcontrol.h"
+
+// The last interrupt may still be pending when Cleanup deletes us
+static void
+SampleHandler (void *arg)
+{
+    (void) arg;
+    if (loadcontrol != NULL)
+        loadcontrol->Sample ();
+}
+
+//----------------------------------------------------------------------
+// LoadControl::LoadControl
+//      Start sampling working sets every "ticks" ticks.
+//----------------------------------------------------------------------
+
+LoadControl::LoadControl (int ticks)
+{
+    interval = ticks;
+    interrupt->Schedule (SampleHandler, NULL, interval, TimerInt);
+}
+
+LoadControl::~LoadControl ()
+{
+    while (!suspended.IsEmpty ())
+        delete (Suspension *) suspended.Remove ();
+}
+
+//----------------------------------------------------------------------
+// LoadControl::Sample
+//      Update the working set of every address space, then suspend or
+//      readmit a process if needed.
+//----------------------------------------------------------------------
+
+void
+LoadControl::Sample (void)
+{
+    ListElement *element;
+    AddrSpace *youngest = NULL;
+    int youngestWorkingSet = 0;
+    int active = 0, total = 0;
+    int capacity = NumPhysPages - 1;    // all but the zero frame
+
+    interrupt->Schedule (SampleHandler, NULL, interval, TimerInt);
+    stats->numWorkingSetSamples++;
+
+    for (element = AddrSpaceList.FirstElement (); element; element = element->next)
+      {
+        AddrSpace *space = (AddrSpace *) element->item;
+        int ws = space->SampleWorkingSet ();
+
+        DEBUG ('w', "Working set of %p: %d pages%s\n", space, ws,
+               IsSuspended (space) ? " (suspended)" : "");
+        if (IsSuspended (space))
+            continue;
+        active++;
+        total += ws;
+        youngest = space;
+        youngestWorkingSet = ws;
+      }
+    if (total > stats->maxWorkingSetTotal)
+        stats->maxWorkingSetTotal = total;
+
+    if (total > capacity && active > 1)
+        Suspend (youngest, youngestWorkingSet);
+    else if (!suspended.IsEmpty ())
+      {
+        Suspension *s = (Suspension *) suspended.FirstElement ()->item;
+        if (total + s->workingSet <= capacity || active == 0)
+          {
+            Readmit (s);
+            stats->numReadmissions++;
+          }
+      }
+}
+
+//----------------------------------------------------------------------
+// LoadControl::IsSuspended
+//      Is the process running in "space" suspended?
+//----------------------------------------------------------------------
+
+bool
+LoadControl::IsSuspended (AddrSpace * space)
+{
+    ListElement *element;
+
+    for (element = suspended.FirstElement (); element; element = element->next)
+        if (((Suspension *) element->item)->space == space)
+            return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// LoadControl::Forget
+//      Called when the process running in "space" exits.  Its
+//      remaining threads, if any, run again to finish.
+//----------------------------------------------------------------------
+
+void
+LoadControl::Forget (AddrSpace * space)
+{
+    ListElement *element;
+
+    for (element = suspended.FirstElement (); element; element = element->next)
+        if (((Suspension *) element->item)->space == space)
+          {
+            Readmit ((Suspension *) element->item);
+            return;
+          }
+}
+
+//----------------------------------------------------------------------
+// LoadControl::Park
+//      Set "thread" aside instead of running it, if its process is
+//      suspended.
+//----------------------------------------------------------------------
+
+bool
+LoadControl::Park (Thread * thread)
+{
+    if (thread->space == NULL || !IsSuspended (thread->space))
+        return FALSE;
+
+    DEBUG ('w', "Parking thread %p \"%s\"\n", thread, thread->getName ());
+    thread->setStatus (BLOCKED);
+    parked.Append (thread);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// LoadControl::Suspend
+//      Stop scheduling the threads of "space", whose working set is
+//      "workingSet" pages.  If one of them is running, it gets parked
+//      when it yields on return from the interrupt.
+//----------------------------------------------------------------------
+
+void
+LoadControl::Suspend (AddrSpace * space, int workingSet)
+{
+    Suspension *s = new Suspension;
+
+    DEBUG ('w', "Suspending %p, working set %d pages\n", space, workingSet);
+    s->space = space;
+    s->workingSet = workingSet;
+    suspended.Append (s);
+    stats->numSuspensions++;
+    interrupt->YieldOnReturn ();
+}
+
+//----------------------------------------------------------------------
+// LoadControl::Readmit
+//      Make the threads of a suspended process runnable again.
+//----------------------------------------------------------------------
+
+void
+LoadControl::Readmit (Suspension * s)
+{
+    List stillParked;
+    Thread *thread;
+
+    DEBUG ('w', "Readmitting %p, working set %d pages\n", s->space, s->workingSet);
+    suspended.Remove (s);
+    while ((thread = (Thread *) parked.Remove ()) != NULL)
+        if (thread->space == s->space)
+            scheduler->ReadyToRun (thread);
+        else
+            stillParked.Append (thread);
+    while ((thread = (Thread *) stillParked.Remove ()) != NULL)
+        parked.Append (thread);
+    delete s;
+}
+
+#endif // CHANGED
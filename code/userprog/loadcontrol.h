@@ -0,0 +1,57 @@
+#ifdef CHANGED
+
+// loadcontrol.h
+//      Working-set based load control.
+//
+//      Every "interval" ticks, the use bit of every page is sampled and
+//      cleared, and shifted into a per-page history of the last
+//      WorkingSetWindow samples: the working set of an address space is
+//      the set of pages referenced during that window.
+//
+//      When the working sets of the active processes no longer fit in
+//      physical memory, the most recently created process is suspended:
+//      its threads are kept out of the ready list, and its pages are
+//      the first ones to be swapped out.  Suspended processes are
+//      readmitted, oldest suspension first, once their working set fits
+//      again beside the active ones.
+
+#ifndef LOADCONTROL_H
+#define LOADCONTROL_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+#include "thread.h"
+#include "addrspace.h"
+
+class LoadControl:public dontcopythis
+{
+  public:
+    LoadControl (int interval); // Sample every "interval" ticks
+    ~LoadControl ();
+
+    void Sample (void);         // Called on each sampling interrupt
+    bool IsSuspended (AddrSpace * space);
+    void Forget (AddrSpace * space); // "space" is being deleted
+    bool Park (Thread * thread); // Called by the scheduler on picking
+                                // "thread".  TRUE if it belongs to a
+                                // suspended process and was set aside.
+
+  private:
+    struct Suspension
+    {
+        AddrSpace *space;
+        int workingSet;         // when it was suspended
+    };
+
+    void Suspend (AddrSpace * space, int workingSet);
+    void Readmit (Suspension * s);
+
+    int interval;
+    List suspended;             // Suspensions, oldest first
+    List parked;                // threads of suspended processes
+};
+
+#endif // LOADCONTROL_H
+
+#endif // CHANGED
@@ -0,0 +1,198 @@
+#ifdef CHANGED
+
+// mmap.cc
+//      Routines to page mapped files in and out.
+
+#include "copyright.h"
+#include "system.h"
+#include "mmap.h"
+#include "filetable.h"
+
+//----------------------------------------------------------------------
+// MappedFile::MappedFile
+//      The open file "f", with none of its pages in memory yet.  It
+//      keeps "f" open as long as it exists.
+//----------------------------------------------------------------------
+
+MappedFile::MappedFile (SharedFile * f)
+{
+    file = f;
+    file->users++;
+    length = file->file->Length ();
+    numPages = divRoundUp (length, PageSize);
+    frames = new int[numPages];
+    for (int i = 0; i < numPages; i++)
+        frames[i] = -1;
+    users = 0;
+}
+
+MappedFile::~MappedFile ()
+{
+    delete [] frames;
+    filetable->Release (file);
+}
+
+//----------------------------------------------------------------------
+// MapCache::Acquire
+//      Return the mapped file of "file", with one more user.  The file
+//      stays open as long as it is mapped.
+//----------------------------------------------------------------------
+
+MappedFile *
+MapCache::Acquire (SharedFile * file)
+{
+    MappedFile *mapped = Find (file);
+
+    if (mapped != NULL)
+      {
+        mapped->users++;
+        return mapped;
+      }
+
+    mapped = new MappedFile (file);
+    mapped->users = 1;
+    files.Append (mapped);
+    DEBUG ('a', "Mapping file of sector %d, %d pages\n",
+           file->sector, mapped->numPages);
+    return mapped;
+}
+
+//----------------------------------------------------------------------
+// MapCache::Find
+//      Return the MappedFile of the open file "file", or NULL if it is
+//      not mapped.
+//----------------------------------------------------------------------
+
+MappedFile *
+MapCache::Find (SharedFile * file)
+{
+    for (ListElement *element = files.FirstElement (); element; element = element->next)
+        if (((MappedFile *) element->item)->file == file)
+            return (MappedFile *) element->item;
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// MapCache::SharedPage
+//      Return the frame caching "page" of "mapped", reading it from the
+//      file on the first use.  The caller gets a reference on the frame,
+//      besides the one of the cache.
+//----------------------------------------------------------------------
+
+int
+MapCache::SharedPage (MappedFile * mapped, int page)
+{
+    ASSERT (page >= 0 && page < mapped->numPages);
+    if (mapped->frames[page] < 0)
+      {
+        int frame = pageprovider->GetEmptyPage ();
+        if (frame < 0)
+            return -1;
+        mapped->file->file->ReadAt (&machine->mainMemory[frame * PageSize],
+                                    PageSize, page * PageSize);
+        mapped->frames[page] = frame;
+        stats->numMmapPageIns++;
+      }
+    pageprovider->ShareFrame (mapped->frames[page]);
+    return mapped->frames[page];
+}
+
+//----------------------------------------------------------------------
+// MapCache::PrivatePage
+//      Return a new frame holding a copy of "page" of "mapped", taken
+//      from the shared cache if the page is there, else from the file.
+//----------------------------------------------------------------------
+
+int
+MapCache::PrivatePage (MappedFile * mapped, int page)
+{
+    int frame = pageprovider->GetEmptyPage ();
+
+    ASSERT (page >= 0 && page < mapped->numPages);
+    if (frame < 0)
+        return -1;
+    if (mapped->frames[page] >= 0)
+        memcpy (&machine->mainMemory[frame * PageSize],
+                &machine->mainMemory[mapped->frames[page] * PageSize], PageSize);
+    else
+      {
+        mapped->file->file->ReadAt (&machine->mainMemory[frame * PageSize],
+                                    PageSize, page * PageSize);
+        stats->numMmapPageIns++;
+      }
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// MapCache::WriteBack
+//      Write "frame" to "page" of "mapped".  The file is never extended.
+//----------------------------------------------------------------------
+
+void
+MapCache::WriteBack (MappedFile * mapped, int page, int frame)
+{
+    int size = std::min ((int) PageSize, mapped->length - page * PageSize);
+
+    DEBUG ('a', "Writing back page %d of sector %d from frame %d\n",
+           page, mapped->file->sector, frame);
+    mapped->file->file->WriteAt (&machine->mainMemory[frame * PageSize],
+                                 size, page * PageSize);
+    stats->numMmapWritebacks++;
+}
+
+//----------------------------------------------------------------------
+// MapCache::Release
+//      Drop one user of "mapped".  When there is none left, give back
+//      the frames of the cache and close the file.
+//----------------------------------------------------------------------
+
+void
+MapCache::Release (MappedFile * mapped)
+{
+    ASSERT (mapped->users > 0);
+    if (--mapped->users > 0)
+        return;
+
+    DEBUG ('a', "Unmapping file of sector %d\n", mapped->file->sector);
+    for (int i = 0; i < mapped->numPages; i++)
+        if (mapped->frames[i] >= 0)
+            pageprovider->ReleasePage (mapped->frames[i]);
+    files.Remove (mapped);
+    delete mapped;
+}
+
+//----------------------------------------------------------------------
+// MapCache::CopyCached
+//      "size" bytes at "data" were just read from "file" at "position",
+//      if "reading", else written to it.  Where they fall in pages
+//      cached for shared mappings, the frames hold the current contents
+//      of the file: copy them over what was read, or what was written
+//      into them, so that a later write back does not undo it.
+//----------------------------------------------------------------------
+
+void
+MapCache::CopyCached (SharedFile * file, char *data, int position, int size,
+                      bool reading)
+{
+    MappedFile *mapped = Find (file);
+
+    if (mapped == NULL)
+        return;
+    for (int page = position / PageSize;
+         page < mapped->numPages && page * PageSize < position + size; page++)
+      {
+        if (mapped->frames[page] < 0)
+            continue;
+        int from = std::max (position, page * PageSize);
+        int to = std::min (position + size, (page + 1) * PageSize);
+        char *cached = &machine->mainMemory[mapped->frames[page] * PageSize
+                                            + from % PageSize];
+
+        if (reading)
+            memmove (data + from - position, cached, to - from);
+        else
+            memmove (cached, data + from - position, to - from);
+      }
+}
+
+#endif // CHANGED
@@ -0,0 +1,83 @@
+#ifdef CHANGED
+
+// mmap.h
+//      Mapping of files into user address spaces.
+//
+//      Mmap reserves a range of virtual pages past the stack region;
+//      the pages are read from the file on the first fault, one page
+//      per fault, straight into the frame the user program then
+//      accesses.
+//
+//      The frames of shared mappings (MAP_SHARED) are cached per file,
+//      opened through the table of open files (see filetable.h): every
+//      process mapping the same page of the same file maps the same
+//      frame, and sees the writes of the others.  Each mapping process
+//      writes its dirty pages back to the file when it unmaps them or
+//      exits.  Meanwhile Read and Write on the file go through the
+//      cached frames, which are newer than the file.  Private mappings
+//      (MAP_PRIVATE) get a copy of the page, and are never written back.
+
+#ifndef MMAP_H
+#define MMAP_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+
+class SharedFile;
+
+class MappedFile:public dontcopythis
+{
+  public:
+    MappedFile (SharedFile * file);
+    ~MappedFile ();
+
+    SharedFile *file;           // the file, open as long as it is mapped
+    int length;                 // its length in bytes when first mapped
+    int numPages;
+    int *frames;                // frame caching each page for shared
+                                // mappings, or -1
+    int users;                  // mappings of this file
+};
+
+// A range of pages of an address space mapping a file
+class Mapping:public dontcopythis
+{
+  public:
+    unsigned int firstPage;     // first virtual page
+    unsigned int numPages;
+    int filePage;               // page of the file mapped at firstPage
+    MappedFile *file;
+    bool shared;                // MAP_SHARED rather than MAP_PRIVATE
+};
+
+class MapCache:public dontcopythis
+{
+  public:
+    MappedFile *Acquire (SharedFile * file); // Take the open "file" for
+                                // mapping, or share it if it is already
+                                // mapped
+    int SharedPage (MappedFile * mapped, int page); // Frame holding
+                                // "page", with one reference for the
+                                // caller.  -1 if out of frames.
+    int PrivatePage (MappedFile * mapped, int page); // New frame holding
+                                // a copy of "page".  -1 if out of frames.
+    void WriteBack (MappedFile * mapped, int page, int frame); // Save
+                                // "frame" as "page" of the file
+    void Release (MappedFile * mapped); // One mapping of "mapped" is gone
+    void CopyCached (SharedFile * file, char *data, int position, int size,
+                     bool reading); // Bring the "size" bytes at "data",
+                                // just read from or written to "file" at
+                                // "position", in line with the frames
+                                // cached for it
+
+  private:
+    List files;                 // MappedFiles currently mapped
+
+    MappedFile *Find (SharedFile * file); // The MappedFile of "file", or
+                                // NULL
+};
+
+#endif // MMAP_H
+
+#endif // CHANGED
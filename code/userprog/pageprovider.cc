@@ -0,0 +1,215 @@
+#ifdef CHANGED
+
+// pageprovider.cc
+//      Routines to allocate and share physical page frames.
+
+#include "copyright.h"
+#include "system.h"
+#include "pageprovider.h"
+
+//----------------------------------------------------------------------
+// PageProvider::PageProvider
+//      Initialize the frame allocator, and set aside frame 0 as the
+//      shared zero frame.
+//
+//      "nframes" is the number of physical frames in the machine
+//----------------------------------------------------------------------
+
+PageProvider::PageProvider (int nframes)
+{
+    numFrames = nframes;
+    frameMap = new BitMap (numFrames);
+    refCount = new int[numFrames];
+    reservedFor = new const void *[numFrames];
+    for (int i = 0; i < numFrames; i++)
+      {
+        refCount[i] = 0;
+        reservedFor[i] = NULL;
+      }
+    numReserved = 0;
+
+    zeroFrame = 0;
+    frameMap->Mark (zeroFrame);
+    refCount[zeroFrame] = 1;    // never dropped
+    memset (&machine->mainMemory[zeroFrame * PageSize], 0, PageSize);
+}
+
+PageProvider::~PageProvider ()
+{
+    delete [] reservedFor;
+    delete [] refCount;
+    delete frameMap;
+}
+
+//----------------------------------------------------------------------
+// PageProvider::GetEmptyPage
+//      Allocate a frame and fill it with zeros.  If there is no free
+//      frame, take a reserved one, else swap a page out if swapping is
+//      enabled.  Return the frame number, or -1 if memory is exhausted.
+//----------------------------------------------------------------------
+
+int
+PageProvider::GetEmptyPage ()
+{
+    int frame = frameMap->Find ();
+
+    if (frame < 0 && numReserved > 0)
+        frame = StealReserved ();
+
+    while (frame < 0 && swap != NULL && swap->EvictPage ())
+        frame = frameMap->Find ();
+
+    if (frame < 0)
+        return -1;
+
+    refCount[frame] = 1;
+    memset (&machine->mainMemory[frame * PageSize], 0, PageSize);
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// PageProvider::ShareFrame
+//      Record one more mapping of "frame".
+//----------------------------------------------------------------------
+
+void
+PageProvider::ShareFrame (int frame)
+{
+    ASSERT_MSG (frame >= 0 && frame < numFrames && frameMap->Test (frame),
+                "Sharing unallocated frame %d\n", frame);
+    if (frame != zeroFrame)
+        refCount[frame]++;
+}
+
+//----------------------------------------------------------------------
+// PageProvider::ReleasePage
+//      Drop one mapping of "frame", and put it back in the free pool
+//      when nobody maps it any more.  The zero frame is never freed.
+//----------------------------------------------------------------------
+
+void
+PageProvider::ReleasePage (int frame)
+{
+    ASSERT_MSG (frame >= 0 && frame < numFrames && frameMap->Test (frame),
+                "Releasing unallocated frame %d\n", frame);
+    if (frame == zeroFrame)
+        return;
+
+    ASSERT (refCount[frame] > 0);
+    if (--refCount[frame] == 0)
+        frameMap->Clear (frame);
+}
+
+//----------------------------------------------------------------------
+// PageProvider::RefCount
+//      Return how many mappings "frame" has.
+//----------------------------------------------------------------------
+
+int
+PageProvider::RefCount (int frame)
+{
+    ASSERT (frame >= 0 && frame < numFrames);
+    return refCount[frame];
+}
+
+//----------------------------------------------------------------------
+// PageProvider::NumAvailPage
+//      Return the number of free frames.
+//----------------------------------------------------------------------
+
+int
+PageProvider::NumAvailPage ()
+{
+    return frameMap->NumClear () + numReserved;
+}
+
+//----------------------------------------------------------------------
+// PageProvider::ReserveRun
+//      Find SuperPagePages free frames, starting at a multiple of
+//      SuperPagePages, and set them aside for "owner".  Return the
+//      first one, or -1 if there is no such run.
+//----------------------------------------------------------------------
+
+int
+PageProvider::ReserveRun (const void *owner)
+{
+    for (int first = 0; first + SuperPagePages <= numFrames; first += SuperPagePages)
+      {
+        int i;
+
+        for (i = 0; i < SuperPagePages && !frameMap->Test (first + i); i++)
+            ;
+        if (i < SuperPagePages)
+            continue;
+
+        for (i = 0; i < SuperPagePages; i++)
+          {
+            frameMap->Mark (first + i);
+            reservedFor[first + i] = owner;
+          }
+        numReserved += SuperPagePages;
+        stats->numSuperpageReservations++;
+        return first;
+      }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// PageProvider::TakeReserved
+//      Allocate "frame" out of a run reserved by "owner", and fill it
+//      with zeros.  Return -1 if the reservation was broken meanwhile.
+//----------------------------------------------------------------------
+
+int
+PageProvider::TakeReserved (int frame, const void *owner)
+{
+    ASSERT (frame >= 0 && frame < numFrames);
+    if (reservedFor[frame] != owner)
+        return -1;
+
+    reservedFor[frame] = NULL;
+    numReserved--;
+    refCount[frame] = 1;
+    memset (&machine->mainMemory[frame * PageSize], 0, PageSize);
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// PageProvider::CancelRun
+//      Give back the frames of the run at "first" that "owner" did not
+//      take.
+//----------------------------------------------------------------------
+
+void
+PageProvider::CancelRun (int first, const void *owner)
+{
+    for (int i = first; i < first + SuperPagePages; i++)
+        if (reservedFor[i] == owner)
+          {
+            reservedFor[i] = NULL;
+            numReserved--;
+            frameMap->Clear (i);
+          }
+}
+
+//----------------------------------------------------------------------
+// PageProvider::StealReserved
+//      Take a frame out of some reservation, for an allocation that
+//      found no free frame.  Return it, still marked in frameMap.
+//----------------------------------------------------------------------
+
+int
+PageProvider::StealReserved (void)
+{
+    for (int i = 0; i < numFrames; i++)
+        if (reservedFor[i] != NULL)
+          {
+            reservedFor[i] = NULL;
+            numReserved--;
+            stats->numSuperpageReservationsBroken++;
+            return i;
+          }
+    return -1;
+}
+
+#endif // CHANGED
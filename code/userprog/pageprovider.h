@@ -0,0 +1,68 @@
+#ifdef CHANGED
+
+// pageprovider.h
+//      Allocation of physical page frames to address spaces.
+//
+//      Frames are reference counted, so that several address spaces
+//      (or several pages of a single address space) can map the same
+//      frame read-only.  Frame 0 is reserved as the shared zero frame:
+//      it is never handed out, never written, and is the initial
+//      mapping of every page that only has to start as zeros (bss, stack).
+//
+//      For superpages, an address space can reserve an aligned run of
+//      SuperPagePages free frames, and then take them one by one as the
+//      matching virtual pages get populated.  Reserved frames that are
+//      not taken yet still count as available: when nothing else is
+//      free, they are handed out to whoever needs a frame, breaking the
+//      reservation.
+
+#ifndef PAGEPROVIDER_H
+#define PAGEPROVIDER_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "bitmap.h"
+
+class PageProvider:public dontcopythis
+{
+  public:
+    PageProvider (int numFrames); // Manage frames 0 .. numFrames-1
+    ~PageProvider ();
+
+    int GetEmptyPage (void);    // Allocate a zero-filled frame, with one
+                                // reference.  Return -1 if none is free.
+    void ShareFrame (int frame); // Take one more reference on "frame"
+    void ReleasePage (int frame); // Drop one reference on "frame", and
+                                // free it when the last one is gone
+    int RefCount (int frame);   // Number of references on "frame"
+    int NumAvailPage (void);    // Number of free frames
+
+    int ZeroFrame (void)        // The shared read-only zero frame
+    {
+        return zeroFrame;
+    }
+
+    int ReserveRun (const void *owner); // Reserve an aligned run of
+                                // SuperPagePages free frames for "owner",
+                                // and return the first one, or -1
+    int TakeReserved (int frame, const void *owner); // Allocate "frame",
+                                // if it is still reserved for "owner",
+                                // like GetEmptyPage.  Else return -1.
+    void CancelRun (int first, const void *owner); // Free the frames of
+                                // the run at "first" still reserved for
+                                // "owner"
+
+  private:
+    BitMap *frameMap;           // which frames are allocated or reserved
+    int *refCount;              // references held on each frame
+    const void **reservedFor;   // owner of each reserved frame, or NULL
+    int numReserved;            // frames reserved and not taken
+    int numFrames;
+    int zeroFrame;
+
+    int StealReserved (void);   // Break a reservation for one frame
+};
+
+#endif // PAGEPROVIDER_H
+
+#endif // CHANGED
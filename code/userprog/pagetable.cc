@@ -0,0 +1,235 @@
+#ifdef CHANGED
+
+// pagetable.cc
+//      Routines to manage flat and two-level page tables.
+
+#include "copyright.h"
+#include "system.h"
+#include "pagetable.h"
+
+//----------------------------------------------------------------------
+// twoLevelPageTables
+//      Format of the page tables of new address spaces, see -pt2.
+//----------------------------------------------------------------------
+
+bool twoLevelPageTables = FALSE;
+
+// An entry for page "vpn" that is not mapped yet
+static void
+InitEntry (TranslationEntry * entry, unsigned int vpn)
+{
+    entry->virtualPage = vpn;
+    entry->physicalPage = 0;
+    entry->valid = FALSE;
+    entry->readOnly = FALSE;
+    entry->use = FALSE;
+    entry->dirty = FALSE;
+    entry->superpage = FALSE;
+}
+
+//----------------------------------------------------------------------
+// PageTable::PageTable
+//      An empty page table, in the format selected by -pt2.
+//----------------------------------------------------------------------
+
+PageTable::PageTable ()
+{
+    twoLevel = twoLevelPageTables;
+    numPages = 0;
+    entries = NULL;
+    flags = history = NULL;
+    chunks = NULL;
+    directory = NULL;
+    numChunks = 0;
+    populated = 0;
+}
+
+PageTable::~PageTable ()
+{
+    for (unsigned int i = 0; i < numChunks; i++)
+        delete chunks[i];
+    delete [] chunks;
+    delete [] directory;
+    delete [] entries;
+    delete [] flags;
+    delete [] history;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Resize
+//      Make the table cover "n" pages.  The table only grows.  In the
+//      two-level format, only the directory is extended.
+//----------------------------------------------------------------------
+
+void
+PageTable::Resize (unsigned int n)
+{
+    unsigned int i;
+
+    ASSERT (n >= numPages);
+    if (twoLevel)
+      {
+        unsigned int n2 = divRoundUp (n, SecondLevelPages);
+        Chunk **newChunks = new Chunk *[n2];
+        TranslationEntry **newDirectory = new TranslationEntry *[n2];
+
+        for (i = 0; i < n2; i++)
+          {
+            newChunks[i] = i < numChunks ? chunks[i] : NULL;
+            newDirectory[i] = i < numChunks ? directory[i] : NULL;
+          }
+        delete [] chunks;
+        delete [] directory;
+        chunks = newChunks;
+        directory = newDirectory;
+        numChunks = n2;
+      }
+    else
+      {
+        TranslationEntry *newEntries = new TranslationEntry[n];
+        unsigned char *newFlags = new unsigned char[n];
+        unsigned char *newHistory = new unsigned char[n];
+
+        for (i = 0; i < n; i++)
+            if (i < numPages)
+              {
+                newEntries[i] = entries[i];
+                newFlags[i] = flags[i];
+                newHistory[i] = history[i];
+              }
+            else
+              {
+                InitEntry (&newEntries[i], i);
+                newFlags[i] = newHistory[i] = 0;
+              }
+        delete [] entries;
+        delete [] flags;
+        delete [] history;
+        entries = newEntries;
+        flags = newFlags;
+        history = newHistory;
+      }
+    numPages = n;
+    if (Bytes () > stats->maxPageTableBytes)
+        stats->maxPageTableBytes = Bytes ();
+}
+
+//----------------------------------------------------------------------
+// PageTable::Populate
+//      Return the second-level table of page "vpn", allocating it with
+//      invalid entries if it does not exist yet.
+//----------------------------------------------------------------------
+
+PageTable::Chunk *
+PageTable::Populate (unsigned int vpn)
+{
+    unsigned int i = vpn / SecondLevelPages;
+
+    ASSERT (twoLevel && vpn < numPages);
+    if (chunks[i] == NULL)
+      {
+        chunks[i] = new Chunk;
+        for (unsigned int j = 0; j < SecondLevelPages; j++)
+          {
+            InitEntry (&chunks[i]->entries[j], i * SecondLevelPages + j);
+            chunks[i]->flags[j] = chunks[i]->history[j] = 0;
+          }
+        directory[i] = chunks[i]->entries;
+        populated++;
+        stats->numSecondLevelTables++;
+        if (Bytes () > stats->maxPageTableBytes)
+            stats->maxPageTableBytes = Bytes ();
+      }
+    return chunks[i];
+}
+
+//----------------------------------------------------------------------
+// PageTable::operator[], Flags, History
+//      Return the entry, the software state, or the use history of
+//      page "vpn", for reading or writing.
+//----------------------------------------------------------------------
+
+TranslationEntry &
+PageTable::operator[] (unsigned int vpn)
+{
+    if (!twoLevel)
+        return entries[vpn];
+    return Populate (vpn)->entries[vpn % SecondLevelPages];
+}
+
+unsigned char &
+PageTable::Flags (unsigned int vpn)
+{
+    if (!twoLevel)
+        return flags[vpn];
+    return Populate (vpn)->flags[vpn % SecondLevelPages];
+}
+
+unsigned char &
+PageTable::History (unsigned int vpn)
+{
+    if (!twoLevel)
+        return history[vpn];
+    return Populate (vpn)->history[vpn % SecondLevelPages];
+}
+
+//----------------------------------------------------------------------
+// PageTable::Populated
+//      Return whether page "vpn" has an entry, without allocating one.
+//      Pages without an entry are invalid.
+//----------------------------------------------------------------------
+
+bool
+PageTable::Populated (unsigned int vpn)
+{
+    if (vpn >= numPages)
+        return FALSE;
+    return !twoLevel || chunks[vpn / SecondLevelPages] != NULL;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Install
+//      Tell the machine where to find this page table.
+//----------------------------------------------------------------------
+
+void
+PageTable::Install (void)
+{
+    machine->currentPageTable = twoLevel ? NULL : entries;
+    machine->currentPageDirectory = twoLevel ? directory : NULL;
+    machine->currentPageTableSize = numPages;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Flatten
+//      Return a new flat array with a copy of every entry.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Flatten (void)
+{
+    TranslationEntry *flat = new TranslationEntry[numPages];
+
+    for (unsigned int i = 0; i < numPages; i++)
+        if (Populated (i))
+            flat[i] = (*this)[i];
+        else
+            InitEntry (&flat[i], i);
+    return flat;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Bytes
+//      Return the memory used by the table.
+//----------------------------------------------------------------------
+
+int
+PageTable::Bytes (void)
+{
+    if (!twoLevel)
+        return numPages * (sizeof (TranslationEntry) + 2);
+    return numChunks * (sizeof (Chunk *) + sizeof (TranslationEntry *))
+        + populated * sizeof (Chunk);
+}
+
+#endif // CHANGED
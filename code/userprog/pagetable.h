@@ -0,0 +1,84 @@
+#ifdef CHANGED
+
+// pagetable.h
+//      Page tables of address spaces, in one of two formats.
+//
+//      The flat format is a single array of TranslationEntry covering
+//      every page of the address space, as the machine originally
+//      expects.  The two-level format (-pt2) is a directory of pointers
+//      to second-level tables of SecondLevelPages entries each, walked
+//      by Machine::Translate; a second-level table is only allocated
+//      once a page in its range is populated, so the unused parts of a
+//      large sparse address space cost one directory slot per
+//      SecondLevelPages pages.
+//
+//      Besides the hardware entries, the table holds the software state
+//      of each page (see AddrSpace::pageFlags) and its use history (see
+//      loadcontrol.h).  Pages which were never populated read as
+//      invalid, with no flags and no history.
+
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "machine.h"
+
+extern bool twoLevelPageTables; // Use the two-level format, see -pt2
+
+class PageTable:public dontcopythis
+{
+  public:
+    PageTable ();
+    ~PageTable ();
+
+    void Resize (unsigned int numPages); // Cover pages 0 .. numPages-1;
+                                // new pages are invalid
+    unsigned int NumPages (void)
+    {
+        return numPages;
+    }
+
+    TranslationEntry & operator[] (unsigned int vpn); // Entry of "vpn",
+                                // populating its second-level table
+    unsigned char &Flags (unsigned int vpn); // Software state of "vpn"
+    unsigned char &History (unsigned int vpn); // Use history of "vpn"
+    bool Populated (unsigned int vpn); // Is there an entry for "vpn"?
+                                // If not, the page is invalid.
+
+    void Install (void);        // Make this the machine's page table
+    TranslationEntry *FlatEntries (void) // The entries of a flat table,
+    {                           // or NULL
+        return twoLevel ? NULL : entries;
+    }
+    TranslationEntry *Flatten (void); // New flat copy, for dumps
+    int Bytes (void);           // Memory used by the table
+
+  private:
+    struct Chunk
+    {
+        TranslationEntry entries[SecondLevelPages];
+        unsigned char flags[SecondLevelPages];
+        unsigned char history[SecondLevelPages];
+    };
+
+    Chunk *Populate (unsigned int vpn); // Second-level table of "vpn"
+
+    bool twoLevel;
+    unsigned int numPages;
+
+    // flat format
+    TranslationEntry *entries;
+    unsigned char *flags;
+    unsigned char *history;
+
+    // two-level format
+    Chunk **chunks;             // second-level tables, or NULL
+    TranslationEntry **directory; // their entries, as the machine sees them
+    unsigned int numChunks;     // directory size
+    int populated;              // second-level tables allocated
+};
+
+#endif // PAGETABLE_H
+
+#endif // CHANGED
@@ -0,0 +1,167 @@
+#ifdef CHANGED
+
+// pipe.cc
+//      Routines to move data through a pipe between user programs.
+
+#include "copyright.h"
+#include "system.h"
+#include "pipe.h"
+#include "synch.h"
+
+#include <string.h>
+
+//----------------------------------------------------------------------
+// Pipe::Pipe
+//      Allocate a ring of "size" bytes.
+//----------------------------------------------------------------------
+
+Pipe::Pipe (int size)
+{
+    ASSERT (size > 0);
+    buffer = new char[size];
+    capacity = size;
+    head = count = 0;
+    readers = writers = 0;
+    lock = new Lock ("pipe");
+    notEmpty = new Condition ("pipe not empty");
+    notFull = new Condition ("pipe not full");
+}
+
+Pipe::~Pipe ()
+{
+    ASSERT (readers == 0 && writers == 0);
+    delete notFull;
+    delete notEmpty;
+    delete lock;
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Attach, Pipe::Detach
+//      Count the descriptors on each end.  When the last one of an end
+//      goes, wake up whoever waits on the other end.
+//----------------------------------------------------------------------
+
+void
+Pipe::Attach (bool writer)
+{
+    lock->Acquire ();
+    if (writer)
+        writers++;
+    else
+        readers++;
+    lock->Release ();
+}
+
+bool
+Pipe::Detach (bool writer)
+{
+    bool unused;
+
+    lock->Acquire ();
+    if (writer)
+      {
+        ASSERT (writers > 0);
+        if (--writers == 0)
+            notEmpty->Broadcast (lock);
+      }
+    else
+      {
+        ASSERT (readers > 0);
+        if (--readers == 0)
+            notFull->Broadcast (lock);
+      }
+    unused = readers == 0 && writers == 0;
+    lock->Release ();
+    return unused;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Read
+//      Wait until there are data, or no writer left, then move what
+//      there is, up to "size" bytes, to user address "to".
+//----------------------------------------------------------------------
+
+int
+Pipe::Read (int to, int size)
+{
+    int done = 0;
+
+    if (size < 0)
+        return -1;
+
+    lock->Acquire ();
+    if (count == 0 && writers > 0 && size > 0)
+        stats->numPipeWaits++;
+    while (count == 0 && writers > 0 && size > 0)
+        notEmpty->Wait (lock);
+
+    while (done < size && count > 0)
+      {
+        unsigned int span;
+        int chunk = std::min (std::min (count, capacity - head), size - done);
+        char *memory = userSpan (to + done, chunk, TRUE, &span);
+
+        if (memory == NULL)
+          {
+            if (done == 0)
+                done = -1;
+            break;
+          }
+        memcpy (memory, buffer + head, span);
+        head = (head + span) % capacity;
+        count -= span;
+        done += span;
+        stats->numBytesCopied += span;
+      }
+
+    if (done > 0)
+        notFull->Broadcast (lock);
+    lock->Release ();
+    return done;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Write
+//      Move "size" bytes from user address "from" into the ring, waiting
+//      for room as needed.  Stop early if every reader is gone.
+//----------------------------------------------------------------------
+
+int
+Pipe::Write (int from, int size)
+{
+    int done = 0;
+
+    if (size < 0)
+        return -1;
+
+    lock->Acquire ();
+    while (done < size)
+      {
+        if (count == capacity && readers > 0)
+            stats->numPipeWaits++;
+        while (count == capacity && readers > 0)
+            notFull->Wait (lock);
+        if (readers == 0)
+            break;
+
+        unsigned int span;
+        int tail = (head + count) % capacity;
+        int chunk = std::min (std::min (capacity - count, capacity - tail),
+                              size - done);
+        char *memory = userSpan (from + done, chunk, FALSE, &span);
+
+        if (memory == NULL)
+            break;
+        memcpy (buffer + tail, memory, span);
+        count += span;
+        done += span;
+        stats->numBytesCopied += span;
+        stats->numPipeBytes += span;
+        notEmpty->Broadcast (lock);
+      }
+    lock->Release ();
+    return done > 0 ? done : (size == 0 ? 0 : -1);
+}
+
+#endif // CHANGED
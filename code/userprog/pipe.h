@@ -0,0 +1,56 @@
+#ifdef CHANGED
+
+// pipe.h
+//      Pipes between user programs.
+//
+//      A pipe is a ring buffer in the kernel, with a read end and a write
+//      end, each held by any number of file descriptors.  The data go
+//      straight between the user buffers and the ring, one run of
+//      contiguous frames at a time.  Readers wait while the ring is
+//      empty, writers while it is full.
+//
+//      Read returns 0 (end of file) once the ring is empty and every
+//      write end is closed; Write fails once every read end is closed.
+
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+class Lock;
+class Condition;
+
+class Pipe:public dontcopythis
+{
+  public:
+    Pipe (int size);            // An empty pipe holding "size" bytes,
+                                // with no end open
+    ~Pipe ();
+
+    void Attach (bool writer);  // One more descriptor on an end
+    bool Detach (bool writer);  // One less.  TRUE if no end is open
+                                // anymore, and the pipe can go.
+
+    int Read (int to, int size); // Read at most "size" bytes to user
+                                // address "to".  Return how many, 0 at
+                                // the end, or -1.
+    int Write (int from, int size); // Write "size" bytes from user
+                                // address "from".  Return how many, or -1.
+
+  private:
+    char *buffer;               // the ring
+    int capacity;
+    int head;                   // offset of the first byte in the ring
+    int count;                  // bytes in the ring
+    int readers, writers;       // descriptors on each end
+    Lock *lock;                 // protects all of the above
+    Condition *notEmpty;        // broadcast when data come in, or the
+                                // last writer goes
+    Condition *notFull;         // broadcast when data go out, or the
+                                // last reader goes
+};
+
+#endif // PIPE_H
+
+#endif // CHANGED
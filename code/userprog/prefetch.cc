@@ -0,0 +1,129 @@
+#ifdef CHANGED
+
+// prefetch.cc
+//      Routines to record, save and replay startup page profiles.
+//
+//      A profile file is a count followed by that many page numbers,
+//      all of them ints.
+
+#include "copyright.h"
+#include "system.h"
+#include "prefetch.h"
+
+//----------------------------------------------------------------------
+// startupPrefetch
+//      Whether processes record and replay startup profiles, see -pf.
+//----------------------------------------------------------------------
+
+bool startupPrefetch = FALSE;
+
+//----------------------------------------------------------------------
+// StartupProfile::StartupProfile
+//      Load the profile of "executable", if it has been run before.
+//----------------------------------------------------------------------
+
+StartupProfile::StartupProfile (const char *executable)
+{
+    OpenFile *file;
+    int count;
+
+    fileName = new char[strlen (executable) + 4];
+    sprintf (fileName, "%s.pf", executable);
+    numPages = numLoaded = 0;
+    startTick = stats->totalTicks;
+
+    file = fileSystem->Open (fileName);
+    if (file == NULL)
+        return;
+    if (file->ReadAt ((char *) &count, sizeof count, 0) == sizeof count
+        && count > 0 && count <= MaxProfilePages
+        && file->ReadAt ((char *) pages, count * sizeof (int), sizeof count)
+           == (int) (count * sizeof (int)))
+        numPages = numLoaded = count;
+    else
+        DEBUG ('a', "Ignoring malformed startup profile %s\n", fileName);
+    delete file;
+}
+
+StartupProfile::~StartupProfile ()
+{
+    delete [] fileName;
+}
+
+//----------------------------------------------------------------------
+// StartupProfile::Prefetch
+//      Back every profiled page of "space" that still needs it, in
+//      address order.  Pages touched for the first time from now on
+//      are recorded for StartupTicks ticks.
+//----------------------------------------------------------------------
+
+void
+StartupProfile::Prefetch (AddrSpace * space)
+{
+    int sorted[MaxProfilePages];
+    int i, j;
+
+    for (i = 0; i < numPages; i++)
+      {
+        for (j = i; j > 0 && sorted[j - 1] > pages[i]; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = pages[i];
+      }
+
+    for (i = 0; i < numPages; i++)
+        if (space->PrefetchPage (sorted[i]))
+            stats->numPagesPrefetched++;
+    DEBUG ('a', "Prefetched %d profiled pages from %s\n", numPages, fileName);
+    startTick = stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// StartupProfile::Record
+//      Add page "vpn" to the profile, if the process is still starting
+//      and it is not there yet: a profiled page which was not prefetched
+//      (see PrefetchReserve) faults again on every run.
+//----------------------------------------------------------------------
+
+void
+StartupProfile::Record (unsigned int vpn)
+{
+    if (stats->totalTicks - startTick > StartupTicks)
+        return;
+    for (int i = 0; i < numPages; i++)
+        if (pages[i] == (int) vpn)
+            return;
+
+    stats->numStartupFaults++;
+    if (numPages < MaxProfilePages)
+        pages[numPages++] = vpn;
+}
+
+//----------------------------------------------------------------------
+// StartupProfile::Save
+//      Write the profile next to the executable, if pages were added
+//      since it was loaded.
+//----------------------------------------------------------------------
+
+void
+StartupProfile::Save (void)
+{
+    OpenFile *file;
+    int size = (numPages + 1) * sizeof (int);
+
+    if (numPages == numLoaded)
+        return;
+    fileSystem->Remove (fileName);
+    if (!fileSystem->Create (fileName, size)
+        || (file = fileSystem->Open (fileName)) == NULL)
+      {
+        DEBUG ('a', "Cannot write startup profile %s\n", fileName);
+        return;
+      }
+    file->WriteAt ((char *) &numPages, sizeof numPages, 0);
+    file->WriteAt ((char *) pages, numPages * sizeof (int), sizeof numPages);
+    delete file;
+    DEBUG ('a', "Saved %d pages to startup profile %s\n", numPages, fileName);
+    numLoaded = numPages;
+}
+
+#endif // CHANGED
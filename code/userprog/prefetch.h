@@ -0,0 +1,55 @@
+#ifdef CHANGED
+
+// prefetch.h
+//      Profile-guided prefetching of the pages a program touches when
+//      it starts.
+//
+//      While a process starts, every page it touches for the first time
+//      through a fault (a zero page written, a stack page grown) is
+//      recorded.  When the process exits, the sequence is saved next to
+//      the executable, in "<executable>.pf" on the Nachos file system.
+//      Later runs of the same executable load the profile and back all
+//      those pages in one go, in address order (i.e. the order of the
+//      sections in the file), before the program starts, instead of
+//      taking one fault per page.
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define MaxProfilePages		64	// pages recorded per executable
+#define StartupTicks		20000	// how long a process is "starting"
+#define PrefetchReserve		(NumPhysPages / 4) // free frames left to
+					// demand paging, so that prefetching
+					// does not push pages out
+
+class AddrSpace;
+
+extern bool startupPrefetch;	// Profile and prefetch startup pages
+
+class StartupProfile:public dontcopythis
+{
+  public:
+    StartupProfile (const char *executable); // Load the profile of
+                                // "executable", if there is one
+    ~StartupProfile ();
+
+    void Prefetch (AddrSpace * space); // Back the profiled pages of
+                                // "space", and start recording
+    void Record (unsigned int vpn); // Page "vpn" was touched for the
+                                // first time
+    void Save (void);           // Write the profile back if it changed
+
+  private:
+    char *fileName;             // "<executable>.pf"
+    int pages[MaxProfilePages]; // profiled pages, in first-touch order
+    int numPages;
+    int numLoaded;              // how many came from the file
+    int startTick;              // when the process started
+};
+
+#endif // PREFETCH_H
+
+#endif // CHANGED
@@ -0,0 +1,261 @@
+#ifdef CHANGED
+
+// process.cc
+//      Routines to create, terminate and wait for user processes.
+
+#include "copyright.h"
+#include "system.h"
+#include "process.h"
+#include "new"
+
+//----------------------------------------------------------------------
+// ProcessTable::ProcessTable
+//      Initialize an empty table of "nprocs" processes.
+//----------------------------------------------------------------------
+
+ProcessTable::ProcessTable (int nprocs)
+{
+    maxProcesses = nprocs;
+    ids = new BitMap (maxProcesses);
+    spaces = new AddrSpace *[maxProcesses];
+    status = new int[maxProcesses];
+    joined = new bool[maxProcesses];
+    parent = new int[maxProcesses];
+    exited = new Semaphore *[maxProcesses];
+    for (int i = 0; i < maxProcesses; i++)
+        exited[i] = NULL;
+    numRunning = 0;
+}
+
+ProcessTable::~ProcessTable ()
+{
+    for (int i = 0; i < maxProcesses; i++)
+        delete exited[i];
+    delete [] exited;
+    delete [] parent;
+    delete [] joined;
+    delete [] status;
+    delete [] spaces;
+    delete ids;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Attach
+//      Record a new process running in "space", and return its id.  Its
+//      parent is the current process, none for the first one.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::Attach (AddrSpace * space)
+{
+    int parentId = IdOf (currentThread->space);
+    int id = ids->Find ();
+
+    if (id < 0)
+        return -1;
+
+    spaces[id] = space;
+    status[id] = 0;
+    joined[id] = FALSE;
+    parent[id] = parentId;
+    exited[id] = new Semaphore ("process exited", 0);
+    numRunning++;
+    return id;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Detach
+//      The process running in "space" has exited with "exitStatus":
+//      keep the status for Join, and wake up whoever waits for it.  Its
+//      children lose their parent, and the exited ones among them, as
+//      well as the process itself if its parent is gone, are forgotten.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Detach (AddrSpace * space, int exitStatus)
+{
+    int self = IdOf (space);
+
+    ASSERT_MSG (self >= 0, "Exiting from an unknown process\n");
+    for (int id = 0; id < maxProcesses; id++)
+        if (ids->Test (id) && parent[id] == self)
+          {
+            parent[id] = -1;
+            if (spaces[id] == NULL)
+                Free (id);
+          }
+
+    spaces[self] = NULL;
+    status[self] = exitStatus;
+    numRunning--;
+    if (parent[self] < 0)
+        Free (self);
+    else
+        exited[self]->V ();
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Join
+//      Wait for process "id" to exit, then free its slot and return its
+//      exit status.  Only the parent of a process can join it, and only
+//      once.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::Join (int id)
+{
+    if (id < 0 || id >= maxProcesses || !ids->Test (id) || joined[id]
+        || parent[id] < 0 || parent[id] != IdOf (currentThread->space))
+        return -1;
+
+    joined[id] = TRUE;
+    exited[id]->P ();
+
+    int exitStatus = status[id];
+    Free (id);
+    return exitStatus;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Free
+//      Give the slot of process "id" back.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Free (int id)
+{
+    delete exited[id];
+    exited[id] = NULL;
+    ids->Clear (id);
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::NumRunning
+//      Return the number of processes which have not exited yet.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::NumRunning (void)
+{
+    return numRunning;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::IdOf
+//      Return the id of the process running in "space", or -1 if there
+//      is none.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::IdOf (AddrSpace * space)
+{
+    if (space == NULL)
+        return -1;              // not the space of an exited process
+    for (int id = 0; id < maxProcesses; id++)
+        if (ids->Test (id) && spaces[id] == space)
+            return id;
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// StartUserProcess
+//      First code run by the thread of a new process: jump to the user
+//      program.
+//----------------------------------------------------------------------
+
+static void
+StartUserProcess (void *arg)
+{
+    AddrSpace *space = (AddrSpace *) arg;
+
+    space->InitRegisters ();	// set the initial register values
+    space->RestoreState ();	// load page table register
+
+    machine->Run ();		// jump to the user progam
+    ASSERT_MSG (FALSE, "Machine->Run returned???\n");
+}
+
+//----------------------------------------------------------------------
+// ExecProcess
+//      Load "filename" into a new address space, and start a thread
+//      running it, with "input" and "output" of the current process as
+//      ConsoleInput and ConsoleOutput (see FileDescriptors::Inherit).
+//      Return the id of the new process, or -1 if the file cannot be
+//      opened, "input" or "output" is not open, or there is no memory or
+//      process slot left.
+//----------------------------------------------------------------------
+
+int
+ExecProcess (const char *filename, int input, int output)
+{
+    OpenFile *executable = fileSystem->Open (filename);
+    AddrSpace *space;
+
+    if (executable == NULL)
+        return -1;
+
+    try
+      {
+        space = new AddrSpace (executable);
+      }
+    catch (std::bad_alloc &)
+      {
+        delete executable;
+        return -1;
+      }
+    delete executable;		// close file
+    if (!space->Files ()->Inherit (currentThread->space->Files (), input, output))
+      {
+        delete space;
+        return -1;
+      }
+    if (startupPrefetch)
+        space->Prefetch (new StartupProfile (filename));
+
+    int id = processTable->Attach (space);
+    if (id < 0)
+      {
+        delete space;
+        return -1;
+      }
+
+    Thread *thread = new Thread ("user process");
+    thread->space = space;
+    thread->Start (StartUserProcess, space);
+    return id;
+}
+
+//----------------------------------------------------------------------
+// ExitProcess
+//      Terminate the current process with "status", and its address
+//      space with it, once its other threads have exited.  The last
+//      process to exit stops the machine.
+//----------------------------------------------------------------------
+
+void
+ExitProcess (int status)
+{
+    AddrSpace *space = currentThread->space;
+
+    space->Threads ()->WaitOthers ();
+    space->SaveProfile ();
+    if (space->GetRing () != NULL)
+        space->GetRing ()->Stop ();
+    if (space->GetAio (FALSE) != NULL)
+        space->GetAio (FALSE)->Stop ();
+    space->UnmapAll ();         // write dirty mapped pages back
+    consoledriver->Flush ();
+    if (processTable->NumRunning () == 1)
+        interrupt->Powerdown ();
+
+    DEBUG ('w', "Process %p exits, peak working set %d pages\n",
+           space, space->PeakWorkingSet ());
+    if (loadcontrol != NULL)
+        loadcontrol->Forget (space);
+    processTable->Detach (space, status);
+    currentThread->space = NULL;
+    delete space;
+    currentThread->Finish ();
+}
+
+#endif // CHANGED
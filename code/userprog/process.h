@@ -0,0 +1,65 @@
+#ifdef CHANGED
+
+// process.h
+//      User processes: one address space each, created by Exec, and
+//      waited for by Join.
+//
+//      Only the process which called Exec, its parent, may Join a
+//      process.  A process keeps its slot in the table, and thus its exit
+//      status, from Exec until it has been joined, or until it has exited
+//      if its parent is gone: nobody can join it then.
+
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "bitmap.h"
+#include "synch.h"
+#include "addrspace.h"
+
+#define MaxProcesses	32	// size of the process table
+
+class ProcessTable:public dontcopythis
+{
+  public:
+    ProcessTable (int maxProcesses);
+    ~ProcessTable ();
+
+    int Attach (AddrSpace * space); // Give a process id to "space", a
+                                // child of the current process.
+                                // Return -1 if the table is full.
+    void Detach (AddrSpace * space, int status); // The process running in
+                                // "space" exits with "status"
+    int Join (int id);          // Wait for child "id" to exit, and
+                                // return its status, or -1 if there is
+                                // no such child to wait for
+    int NumRunning (void);      // Number of processes not yet exited
+    int IdOf (AddrSpace * space); // Id of the process running in "space",
+                                // or -1
+
+  private:
+    int maxProcesses;
+    BitMap *ids;                // slots in use
+    AddrSpace **spaces;         // space of each running process, NULL
+                                // once it has exited
+    int *status;                // exit status of each exited process
+    bool *joined;               // is someone already waiting for it?
+    int *parent;                // id of the parent, -1 once it is gone
+    Semaphore **exited;         // V'ed when each process exits
+    int numRunning;
+
+    void Free (int id);         // Forget process "id"
+};
+
+extern int ExecProcess (const char *filename, int input, int output);
+                                // Start a new process running "filename",
+                                // with the open files "input" and "output"
+                                // of the caller as console.  Return its
+                                // id, or -1.
+extern void ExitProcess (int status) __attribute__ ((__noreturn__));
+                                // Terminate the current process
+
+#endif // PROCESS_H
+
+#endif // CHANGED
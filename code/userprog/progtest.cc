@@ -40,6 +40,11 @@ StartProcess (char *filename)
       }
     space = new AddrSpace (executable);
     currentThread->space = space;
+#ifdef CHANGED
+    processTable->Attach (space);
+    if (startupPrefetch)
+        space->Prefetch (new StartupProfile (filename));
+#endif
 
     delete executable;		// close file
 
@@ -126,6 +131,7 @@ void ConsoleDriverTest(const char *in, const char *out)
 
     fprintf(stderr, "EOF detected in ConsoleDriver!\n");
     
+    test_consoledriver->Flush();
     delete test_consoledriver;
 
 }
@@ -0,0 +1,378 @@
+#ifdef CHANGED
+
+// swap.cc
+//      Routines to swap user pages out to a compressed pool and to disk.
+
+#include "copyright.h"
+#include "system.h"
+#include "swap.h"
+
+//----------------------------------------------------------------------
+// Compress
+//      LZ77 compression of "len" bytes from "in" into "out", which has
+//      room for "outMax" bytes.  Return the compressed size, or -1 if it
+//      does not fit.
+//
+//      The output is a sequence of tokens.  A token byte t < 0x80 is
+//      followed by t+1 literal bytes.  A token byte t >= 0x80 is followed
+//      by one byte o, and means: copy (t & 0x7f) + MinMatch bytes from
+//      o+1 bytes back in the output (possibly overlapping, which encodes
+//      runs).
+//----------------------------------------------------------------------
+
+#define MinMatch	3
+#define MaxMatch	(0x7f + MinMatch)
+#define MaxLiterals	0x80
+#define MaxOffset	0x100
+#define HashSize	256
+
+static int
+Compress (const unsigned char *in, int len, unsigned char *out, int outMax)
+{
+    int last[HashSize];         // last position of each 3-byte prefix
+    int i = 0, o = 0;
+    int literals = 0;           // pending literals, ending at "i"
+
+    for (int h = 0; h < HashSize; h++)
+        last[h] = -1;
+
+    while (i < len)
+      {
+        int match = 0, offset = 0;
+
+        if (i + MinMatch <= len)
+          {
+            int h = (in[i] * 33 * 33 + in[i + 1] * 33 + in[i + 2]) % HashSize;
+            int cand = last[h];
+            last[h] = i;
+            if (cand >= 0 && i - cand <= MaxOffset)
+              {
+                while (i + match < len && match < MaxMatch
+                       && in[cand + match] == in[i + match])
+                    match++;
+                offset = i - cand;
+              }
+          }
+
+        if (match < MinMatch)
+          {
+            literals++;
+            i++;
+            if (literals < MaxLiterals && i < len)
+                continue;
+          }
+
+        if (literals > 0)
+          {
+            if (o + 1 + literals > outMax)
+                return -1;
+            out[o++] = literals - 1;
+            memcpy (&out[o], &in[i - literals], literals);
+            o += literals;
+            literals = 0;
+          }
+
+        if (match >= MinMatch)
+          {
+            if (o + 2 > outMax)
+                return -1;
+            out[o++] = 0x80 | (match - MinMatch);
+            out[o++] = offset - 1;
+            i += match;
+          }
+      }
+    return o;
+}
+
+//----------------------------------------------------------------------
+// Decompress
+//      Expand "inLen" bytes compressed by Compress from "in" into the
+//      "len" bytes of "out".
+//----------------------------------------------------------------------
+
+static void
+Decompress (const unsigned char *in, int inLen, unsigned char *out, int len)
+{
+    int i = 0, o = 0;
+
+    while (i < inLen)
+      {
+        int t = in[i++];
+
+        if (t < 0x80)
+          {
+            ASSERT (o + t + 1 <= len && i + t + 1 <= inLen);
+            memcpy (&out[o], &in[i], t + 1);
+            o += t + 1;
+            i += t + 1;
+          }
+        else
+          {
+            int match = (t & 0x7f) + MinMatch;
+            int offset = in[i++] + 1;
+            ASSERT (o + match <= len && offset <= o);
+            for (int k = 0; k < match; k++, o++)
+                out[o] = out[o - offset];
+          }
+      }
+    ASSERT (o == len);
+}
+
+//----------------------------------------------------------------------
+// SwapManager::SwapManager
+//      Open the swap disk, with an empty pool in front of it.
+//
+//      "size" is the number of bytes of compressed pages the pool holds
+//----------------------------------------------------------------------
+
+SwapManager::SwapManager (int size)
+{
+    disk = new SynchDisk ("SWAP");
+    lock = new Lock ("swap");
+    slotMap = new BitMap (NumSectors);
+    slots = new Slot[NumSectors];
+    for (int i = 0; i < NumSectors; i++)
+      {
+        slots[i].data = NULL;
+        slots[i].length = 0;
+      }
+    poolSize = size;
+    poolUsed = 0;
+
+    handSpace = NULL;
+    handPage = 0;
+}
+
+SwapManager::~SwapManager ()
+{
+    for (int i = 0; i < NumSectors; i++)
+        delete [] slots[i].data;
+    delete [] slots;
+    delete slotMap;
+    delete lock;
+    delete disk;
+}
+
+//----------------------------------------------------------------------
+// SwapManager::FindVictim
+//      Move the clock hand over the pages of all address spaces, giving
+//      a second chance to recently used pages, until reaching a private
+//      page which was not.  Return FALSE if there is no such page.
+//
+//      The pages of suspended processes go first, whether used or not.
+//----------------------------------------------------------------------
+
+bool
+SwapManager::FindVictim (AddrSpace ** space, unsigned int *vpn, int *frame)
+{
+    ListElement *element;
+    int total = 0;
+
+    if (loadcontrol != NULL)
+        for (element = AddrSpaceList.FirstElement (); element; element = element->next)
+          {
+            AddrSpace *s = (AddrSpace *) element->item;
+            if (!loadcontrol->IsSuspended (s))
+                continue;
+            for (unsigned int i = 0; i < s->NumPages (); i++)
+                if ((*frame = s->PrivateFrame (i)) >= 0)
+                  {
+                    *space = s;
+                    *vpn = i;
+                    return TRUE;
+                  }
+          }
+
+    for (element = AddrSpaceList.FirstElement (); element; element = element->next)
+        total += ((AddrSpace *) element->item)->NumPages ();
+
+    for (int step = 0; step < 2 * total; step++)
+      {
+        if (handSpace != NULL && IsAddrSpace (handSpace)
+            && handPage + 1 < handSpace->NumPages ())
+            handPage++;
+        else
+          {
+            // next address space, or back to the first one
+            element = AddrSpaceList.FirstElement ();
+            if (handSpace != NULL && IsAddrSpace (handSpace))
+              {
+                while (element->item != handSpace)
+                    element = element->next;
+                element = element->next;
+                if (element == NULL)
+                    element = AddrSpaceList.FirstElement ();
+              }
+            handSpace = (AddrSpace *) element->item;
+            handPage = 0;
+          }
+
+        int f = handSpace->PrivateFrame (handPage);
+        if (f < 0 || handSpace->TestAndClearUse (handPage))
+            continue;
+
+        *space = handSpace;
+        *vpn = handPage;
+        *frame = f;
+        return TRUE;
+      }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// SwapManager::EvictPage
+//      Swap out a victim page, and give its frame back to the page
+//      provider.
+//----------------------------------------------------------------------
+
+bool
+SwapManager::EvictPage (void)
+{
+    AddrSpace *space;
+    unsigned int vpn;
+    int frame;
+    char page[PageSize];
+
+    lock->Acquire ();
+    int slot = slotMap->Find ();
+    if (slot < 0 || !FindVictim (&space, &vpn, &frame))
+      {
+        if (slot >= 0)
+            slotMap->Clear (slot);
+        lock->Release ();
+        return FALSE;
+      }
+
+    DEBUG ('a', "Swapping out page %d of %p, frame %d, to slot %d\n",
+           vpn, space, frame, slot);
+    space->PageOut (vpn, slot);
+    memcpy (page, &machine->mainMemory[frame * PageSize], PageSize);
+    pageprovider->ReleasePage (frame);
+    stats->numSwapOuts++;
+
+    Store (slot, page);         // may wait for the disk
+    lock->Release ();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SwapManager::Store
+//      Save "page" in "slot": compressed in the pool if it compresses,
+//      making room by writing the oldest pages back, else on the disk.
+//----------------------------------------------------------------------
+
+void
+SwapManager::Store (int slot, const char *page)
+{
+    unsigned char buffer[PageSize];
+    int length = Compress ((const unsigned char *) page, PageSize,
+                           buffer, PageSize - 1);
+
+    if (length < 0 || length > poolSize)
+      {
+        disk->WriteSector (slot, page);
+        stats->numSwapDiskWrites++;
+        return;
+      }
+
+    while (poolUsed + length > poolSize)
+        Writeback ();
+
+    slots[slot].data = new char[length];
+    memcpy (slots[slot].data, buffer, length);
+    slots[slot].length = length;
+    pool.Append (&slots[slot]);
+    poolUsed += length;
+    stats->numZswapStored++;
+    stats->numZswapOriginalBytes += PageSize;
+    stats->numZswapCompressedBytes += length;
+}
+
+//----------------------------------------------------------------------
+// SwapManager::Writeback
+//      Write the page which has been in the pool for the longest time to
+//      its sector on the disk.
+//----------------------------------------------------------------------
+
+void
+SwapManager::Writeback (void)
+{
+    Slot *s = (Slot *) pool.Remove ();
+    char page[PageSize];
+
+    ASSERT (s != NULL);
+    int slot = s - slots;
+    DEBUG ('a', "Writing back slot %d\n", slot);
+    Decompress ((unsigned char *) s->data, s->length, (unsigned char *) page, PageSize);
+    DropFromPool (slot);
+    disk->WriteSector (slot, page);
+    stats->numSwapDiskWrites++;
+    stats->numZswapWritebacks++;
+}
+
+//----------------------------------------------------------------------
+// SwapManager::DropFromPool
+//      Free the compressed copy of "slot".
+//----------------------------------------------------------------------
+
+void
+SwapManager::DropFromPool (int slot)
+{
+    poolUsed -= slots[slot].length;
+    delete [] slots[slot].data;
+    slots[slot].data = NULL;
+    slots[slot].length = 0;
+}
+
+//----------------------------------------------------------------------
+// SwapManager::SwapIn
+//      Copy the page saved in "slot" into "frame", from the pool if it is
+//      still there, else from the disk, and free the slot.
+//----------------------------------------------------------------------
+
+void
+SwapManager::SwapIn (int slot, int frame)
+{
+    char *page = &machine->mainMemory[frame * PageSize];
+
+    lock->Acquire ();
+    ASSERT (slotMap->Test (slot));
+    if (slots[slot].data != NULL)
+      {
+        Decompress ((unsigned char *) slots[slot].data, slots[slot].length,
+                    (unsigned char *) page, PageSize);
+        pool.Remove (&slots[slot]);
+        DropFromPool (slot);
+        stats->numZswapHits++;
+        stats->numSwapDiskWritesAvoided++;
+      }
+    else
+      {
+        disk->ReadSector (slot, page);  // may wait for the disk
+        stats->numZswapMisses++;
+      }
+    slotMap->Clear (slot);
+    lock->Release ();
+}
+
+//----------------------------------------------------------------------
+// SwapManager::FreeSlot
+//      The page saved in "slot" is not needed any more.
+//----------------------------------------------------------------------
+
+void
+SwapManager::FreeSlot (int slot)
+{
+    lock->Acquire ();
+    ASSERT (slotMap->Test (slot));
+    if (slots[slot].data != NULL)
+      {
+        pool.Remove (&slots[slot]);
+        DropFromPool (slot);
+        stats->numSwapDiskWritesAvoided++;
+      }
+    slotMap->Clear (slot);
+    lock->Release ();
+}
+
+#endif // CHANGED
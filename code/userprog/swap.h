@@ -0,0 +1,68 @@
+#ifdef CHANGED
+
+// swap.h
+//      Eviction of user pages when physical memory is exhausted.
+//
+//      Victims are chosen among private writable pages with the clock
+//      algorithm, over all address spaces.  An evicted page is first
+//      compressed into a pool of host memory; only when the pool is
+//      full are its least recently stored pages written back to the
+//      swap disk, uncompressed, one sector per page.  Pages which do not
+//      compress go to the disk directly.
+//
+//      Each swapped page owns a swap slot, which is also the sector it
+//      is written to on the disk.  While a page is swapped out, its page
+//      table entry is invalid and its physicalPage holds the slot.
+
+#ifndef SWAP_H
+#define SWAP_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "bitmap.h"
+#include "list.h"
+#include "synch.h"
+#include "synchdisk.h"
+#include "addrspace.h"
+
+class SwapManager:public dontcopythis
+{
+  public:
+    SwapManager (int poolSize); // Swap to the "SWAP" disk, through a
+                                // pool of "poolSize" bytes
+    ~SwapManager ();
+
+    bool EvictPage (void);      // Swap a user page out, and free its
+                                // frame.  FALSE if no page can be.
+    void SwapIn (int slot, int frame); // Copy "slot" back into "frame",
+                                // and free the slot
+    void FreeSlot (int slot);   // Free "slot", its page is gone
+
+  private:
+    struct Slot
+    {
+        char *data;             // compressed contents while in the pool
+        int length;             // size of "data"
+    };
+
+    bool FindVictim (AddrSpace ** space, unsigned int *vpn, int *frame);
+                                // Clock algorithm
+    void Store (int slot, const char *page); // Save "page" in "slot"
+    void Writeback (void);      // Move the oldest page of the pool to disk
+    void DropFromPool (int slot);
+
+    SynchDisk *disk;
+    Lock *lock;                 // one swap operation at a time
+    BitMap *slotMap;            // slots in use
+    Slot *slots;
+    List pool;                  // slots in the pool, oldest first
+    int poolSize;               // bytes available to the pool
+    int poolUsed;               // bytes used by the pool
+
+    AddrSpace *handSpace;       // clock hand
+    unsigned int handPage;
+};
+
+#endif // SWAP_H
+
+#endif // CHANGED
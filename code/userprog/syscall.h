@@ -35,6 +35,115 @@
 #ifdef CHANGED
     #define SC_PutChar 11
     #define SC_PutString 12
+    #define SC_Mmap 13
+    #define SC_Munmap 14
+    #define SC_GetString 15
+    #define SC_RingSetup 16
+    #define SC_RingEnter 17
+    #define SC_AioRead 18
+    #define SC_AioWrite 19
+    #define SC_AioWait 20
+    #define SC_Pipe 21
+    #define SC_ExecWith 22
+    #define SC_Futex 23
+    #define SC_ThreadCreate 24
+    #define SC_ThreadExit 25
+    #define SC_ThreadJoin 26
+    #define SC_Sbrk 27
+
+    /* Console file ids, known to the kernel too */
+    #define ConsoleInput 0
+    #define ConsoleOutput 1
+
+    /* Pipe capacity when none is given, and the largest one */
+    #define PIPE_SIZE 1024
+    #define PIPE_MAX_SIZE 65536
+
+    /* Futex operations */
+    #define FUTEX_WAIT 0
+    #define FUTEX_WAKE 1
+
+    /* Stack of each thread started by ThreadCreate, in bytes */
+    #define UserThreadStackSize 1024
+
+    /* Mmap flags */
+    #define MAP_PRIVATE 0
+    #define MAP_SHARED 1
+
+    /* Syscall ring: size, RingSetup flags, and Ring flags */
+    #define RING_ENTRIES 8
+    #define RING_SQPOLL 1          /* a kernel thread polls the ring */
+    #define RING_NEED_WAKEUP 1     /* the poller sleeps, call RingEnter */
+
+    /* Status of an asynchronous request not completed yet */
+    #define AIO_PENDING (-2)
+
+    /* Where the kernel info page is mapped, read-only.  A program and
+     * its stack region (see -sl) must end below it.
+     */
+    #define KERNEL_INFO_ADDR 0x8000
+
+    #ifndef __ASSEMBLER__
+    /* A request queued in a syscall ring: "op" is one of SC_PutChar,
+     * SC_PutString, SC_Read, SC_Write or SC_Yield, with the arguments of
+     * that system call.  "tag" is handed back in its completion.
+     */
+    typedef struct {
+        int op;
+        int arg1, arg2, arg3;
+        int tag;
+    } RingRequest;
+
+    typedef struct {
+        int tag;
+        int result;                /* what the system call returns */
+    } RingCompletion;
+
+    /* The ring itself lives in user memory.  The user fills sq[sqTail %
+     * RING_ENTRIES] and advances sqTail; the kernel takes requests from
+     * sqHead, and puts completions at cqTail.  The user consumes them
+     * from cqHead.
+     */
+    typedef struct {
+        unsigned int sqHead, sqTail;
+        unsigned int cqHead, cqTail;
+        int flags;
+        RingRequest sq[RING_ENTRIES];
+        RingCompletion cq[RING_ENTRIES];
+    } Ring;
+
+    /* An asynchronous read or write of "size" bytes between "buffer" and
+     * the open file "id", at "offset" in the file.  The kernel sets
+     * "status" to AIO_PENDING when the request is queued, then to what
+     * Read would return once it is done.
+     */
+    typedef struct {
+        int id;
+    #ifdef IN_USER_MODE
+        void *buffer;
+    #else
+        int buffer;                /* user address, as seen by the kernel */
+    #endif
+        int size;
+        int offset;
+        volatile int status;
+    } AioControl;
+
+    /* The kernel info page, kept up to date by the kernel.  The tick
+     * counters are the low 32 bits of those of the statistics, as of
+     * the last instruction.
+     */
+    typedef struct {
+        unsigned int totalTicks;
+        unsigned int userTicks;
+        unsigned int systemTicks;
+        unsigned int idleTicks;
+        int pid;                   /* id of the running process */
+        int readyThreads;          /* threads waiting for the CPU */
+        int processes;             /* processes not exited yet */
+        unsigned int contextSwitches;
+    } KernelInfo;
+    #endif
 #endif
 
 #ifdef IN_USER_MODE
@@ -94,11 +203,18 @@ typedef int OpenFileId;
  * the console device.
  */
 
+#ifndef CHANGED
 #define ConsoleInput	0
 #define ConsoleOutput	1
+#endif
 
+#ifdef CHANGED
+/* Create a Nachos file, with "name", empty.  Return 0, or -1 on error. */
+int Create (const char *name);
+#else
 /* Create a Nachos file, with "name" */
 void Create (const char *name);
+#endif
 
 /* Open the Nachos file "name", and return an "OpenFileId" that can
  * be used to read and write to the file.
@@ -116,8 +232,15 @@ void Write (const void *buffer, int size, OpenFileId id);
  */
 int Read (void *buffer, int size, OpenFileId id);
 
+#ifdef CHANGED
+/* Close the file, we're done reading and writing to it.  Return 0, or -1
+ * if "id" is not open.
+ */
+int Close (OpenFileId id);
+#else
 /* Close the file, we're done reading and writing to it. */
 void Close (OpenFileId id);
+#endif
 
 
 
@@ -141,6 +264,204 @@ void Yield (void);
 
     /* Uses the console driver to put a string in the terminal */
     void PutString(const char* s);
+
+    /* Reads a line from the terminal into "s", like fgets: at most "n"-1
+     * characters, up to and including the newline, then a '\0'.  An
+     * empty string means the end of input.  Return 0, or -1 if "s" is
+     * not a valid buffer: the line is lost then.
+     */
+    int GetString(char* s, int n);
+
+    /* Register "ring" as the syscall ring of this process.  With
+     * RING_SQPOLL, a kernel thread runs the requests as they are queued,
+     * and only needs a RingEnter when it sets RING_NEED_WAKEUP.  Return 0,
+     * or -1 if there is already a ring or "ring" is a bad address.
+     */
+    int RingSetup(Ring *ring, int flags);
+
+    /* Run the queued requests of the ring, or wake up its poller.  Return
+     * how many requests were run, or -1 if there is no ring.
+     */
+    int RingEnter(void);
+
+    /* Map "length" bytes of the open file "id", starting at "offset" (a
+     * multiple of the page size), into memory, and return their address,
+     * or 0 on error.  The mapping stays after "id" is closed.  With
+     * MAP_SHARED, writes are seen by the other processes mapping the
+     * file, and by Read, and written back to the file on Munmap or Exit;
+     * with MAP_PRIVATE, they stay private to the caller.
+     */
+    void *Mmap(OpenFileId id, int offset, int length, int flags);
+
+    /* Remove the mapping at "addr", returned by Mmap.  Return 0, or -1 if
+     * there is no such mapping.
+     */
+    int Munmap(void *addr);
+
+    /* Queue a read, or a write, described by "control", which must stay
+     * in place until it completes.  Return 0, or -1 if "control" is a bad
+     * address.  The request runs in a kernel thread of the process,
+     * while the program goes on.
+     */
+    int AioRead(AioControl *control);
+    int AioWrite(AioControl *control);
+
+    /* Wait for the request of "control" to complete, and return its
+     * status.
+     */
+    int AioWait(AioControl *control);
+
+    /* Create a pipe holding "size" bytes, PIPE_SIZE if "size" is 0.  Its
+     * read end goes to ids[0] and its write end to ids[1].  Read blocks
+     * until there are data, and returns 0 once every write end is
+     * closed; Write blocks until all the data are in the pipe.  Return 0,
+     * or -1 on error.
+     */
+    int Pipe(OpenFileId ids[2], int size);
+
+    /* Like Exec, but the new process reads the open file "input" when it
+     * reads ConsoleInput, and writes "output" when it writes
+     * ConsoleOutput.  Exec passes on the console of the caller.
+     */
+    SpaceId ExecWith(const char *name, OpenFileId input, OpenFileId output);
+
+    /* Start a thread running func(arg) in the current process, on a stack
+     * of its own of UserThreadStackSize bytes.  Returning from "func" is
+     * ThreadExit with the value returned.  Return the id of the thread,
+     * or -1 if there is no room for one more stack.  Register $k1 holds
+     * the stack slot of each thread, which no other running thread has,
+     * 0 for the main thread.
+     */
+    int ThreadCreate(int (*func)(void *arg), void *arg);
+
+    /* Terminate the current thread with "status", for ThreadJoin.  The
+     * last thread of a process ends it, like Exit.  Exit waits for every
+     * other thread to call ThreadExit.
+     */
+    void ThreadExit(int status) __attribute__((__noreturn__));
+
+    /* Wait for thread "id" to terminate, and return its status, or -1 if
+     * there is no such thread.  The main thread has id 0.  A thread can
+     * be joined only once.
+     */
+    int ThreadJoin(int id);
+
+    /* Move the end of the heap by "increment" bytes, and return where it
+     * was, or (void *) -1 if it would leave the heap region (see -hl).
+     * The heap starts out empty and zero-filled; its pages only take
+     * memory once touched, until the break goes back below them.
+     */
+    void *Sbrk(int increment);
+
+    /* The heap allocator of the user runtime, see test/malloc.c */
+    void *malloc(unsigned int size);
+    void free(void *ptr);
+    void *calloc(unsigned int count, unsigned int size);
+    void *realloc(void *ptr, unsigned int size);
+
+    /* Atomic operations on the word at "addr", which return its old
+     * value: store "desired" if it holds "expected", store "value", and
+     * add "delta".
+     */
+    int CompareAndSwap(volatile int *addr, int expected, int desired);
+    int AtomicSwap(volatile int *addr, int value);
+    int AtomicAdd(volatile int *addr, int delta);
+
+    /* With FUTEX_WAIT, sleep if the word at "addr" still holds "value",
+     * until a FUTEX_WAKE on it, and return 0, or -1 right away if it does
+     * not.  With FUTEX_WAKE, wake at most "value" threads sleeping on it,
+     * and return how many.  "addr" may be in a MAP_SHARED mapping, to
+     * synchronize processes.
+     */
+    int Futex(volatile int *addr, int op, int value);
+
+    /* A mutex which only calls the kernel to wait for the lock, or to
+     * hand it over to a waiter.  "state" is 0 when free, 1 when held,
+     * and 2 when held with someone maybe waiting.
+     */
+    typedef struct {
+        volatile int state;
+    } Mutex;
+
+    static inline void MutexInit(Mutex *m)
+    {
+        m->state = 0;
+    }
+
+    static inline void MutexLock(Mutex *m)
+    {
+        int c = CompareAndSwap(&m->state, 0, 1);
+
+        if (c == 0)
+            return;
+        if (c != 2)
+            c = AtomicSwap(&m->state, 2);
+        while (c != 0) {
+            Futex(&m->state, FUTEX_WAIT, 2);
+            c = AtomicSwap(&m->state, 2);
+        }
+    }
+
+    static inline void MutexUnlock(Mutex *m)
+    {
+        if (AtomicSwap(&m->state, 0) == 2)
+            Futex(&m->state, FUTEX_WAKE, 1);
+    }
+
+    /* A counting semaphore, which only calls the kernel when P has to
+     * wait, or V may have someone to wake up.
+     */
+    typedef struct {
+        volatile int value;
+        volatile int waiters;      /* threads in P which found it 0 */
+    } Sem;
+
+    static inline void SemInit(Sem *s, int value)
+    {
+        s->value = value;
+        s->waiters = 0;
+    }
+
+    static inline void SemP(Sem *s)
+    {
+        for (;;) {
+            int v = s->value;
+
+            if (v > 0) {
+                if (CompareAndSwap(&s->value, v, v - 1) == v)
+                    return;
+            } else {
+                AtomicAdd(&s->waiters, 1);
+                Futex(&s->value, FUTEX_WAIT, v);
+                AtomicAdd(&s->waiters, -1);
+            }
+        }
+    }
+
+    static inline void SemV(Sem *s)
+    {
+        AtomicAdd(&s->value, 1);
+        if (s->waiters > 0)
+            Futex(&s->value, FUTEX_WAKE, 1);
+    }
+
+    /* Read the kernel info page, without a system call */
+    #define KernelInfoPtr ((const volatile KernelInfo *) KERNEL_INFO_ADDR)
+
+    static inline unsigned int GetTicks(void)
+    {
+        return KernelInfoPtr->totalTicks;
+    }
+
+    static inline unsigned int GetUserTicks(void)
+    {
+        return KernelInfoPtr->userTicks;
+    }
+
+    static inline int GetPid(void)
+    {
+        return KernelInfoPtr->pid;
+    }
 #endif
 
 #endif // IN_USER_MODE
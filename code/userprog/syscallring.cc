@@ -0,0 +1,249 @@
+#ifdef CHANGED
+
+// syscallring.cc
+//      Routines to run the system calls queued in a syscall ring.
+
+#include "copyright.h"
+#include "system.h"
+#include "syscall.h"
+#include "syscallring.h"
+#include "exception.h"
+#include "synch.h"
+#include <stddef.h>
+
+//----------------------------------------------------------------------
+// RingPoller
+//      Entry point of the poller thread of "arg", a SyscallRing.
+//----------------------------------------------------------------------
+
+static void
+RingPoller (void *arg)
+{
+    ((SyscallRing *) arg)->Poll ();
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::SyscallRing
+//      Serve the Ring at user address "address" of "space".  With
+//      RING_SQPOLL in "flags", start a poller thread for it.
+//----------------------------------------------------------------------
+
+SyscallRing::SyscallRing (AddrSpace * space, int address, int flags)
+{
+    ringAddr = address;
+    sleeping = stopping = FALSE;
+    busy = new Semaphore ("ring busy", 1);
+    wakeup = new Semaphore ("ring wakeup", 0);
+    stopped = new Semaphore ("ring stopped", 0);
+
+    poller = NULL;
+    if (flags & RING_SQPOLL)
+      {
+        poller = new Thread ("ring poller");
+        poller->space = space;
+        poller->Start (RingPoller, this);
+      }
+}
+
+SyscallRing::~SyscallRing ()
+{
+    ASSERT (poller == NULL || stopping);
+    delete stopped;
+    delete wakeup;
+    delete busy;
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::IsValid
+//      Return TRUE if a whole Ring fits at user address "ringAddr".
+//----------------------------------------------------------------------
+
+bool
+SyscallRing::IsValid (int ringAddr)
+{
+    Ring ring;
+
+    return copyIn (ringAddr, &ring, sizeof (ring));
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::Enter
+//      Called on RingEnter.  Run the queued requests, and return how
+//      many were run.  With a poller, only wake it up if it sleeps.
+//----------------------------------------------------------------------
+
+int
+SyscallRing::Enter ()
+{
+    if (poller == NULL)
+        return Process ();
+
+    if (sleeping)
+      {
+        sleeping = FALSE;
+        wakeup->V ();
+      }
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::Stop
+//      Wait for the poller, if any, to finish.  A request it is running
+//      is completed first.
+//----------------------------------------------------------------------
+
+void
+SyscallRing::Stop ()
+{
+    stopping = TRUE;
+    if (poller == NULL)
+        return;
+    if (sleeping)
+      {
+        sleeping = FALSE;
+        wakeup->V ();
+      }
+    stopped->P ();
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::Poll
+//      Run requests as they get queued, letting the other threads run
+//      between passes.  Sleep after RingPollPasses empty passes, with
+//      RING_NEED_WAKEUP set in the ring.
+//----------------------------------------------------------------------
+
+void
+SyscallRing::Poll ()
+{
+    int idle = 0;
+
+    while (!stopping)
+      {
+        if (Process () > 0)
+            idle = 0;
+        else if (++idle >= RingPollPasses)
+          {
+            sleeping = TRUE;
+            SetFlags (RING_NEED_WAKEUP);
+            // Requests queued before the flag was seen need no RingEnter
+            if (Process () > 0 || stopping)
+              {
+                if (sleeping)
+                    sleeping = FALSE;
+                else
+                    wakeup->P ();   // take back the wakeup of Enter
+              }
+            else
+                wakeup->P ();
+            SetFlags (0);
+            idle = 0;
+            continue;
+          }
+        currentThread->Yield ();
+      }
+    stopped->V ();
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::Process
+//      Run the requests queued in the ring, as long as there is room
+//      for their completions.  Return how many were run.
+//----------------------------------------------------------------------
+
+int
+SyscallRing::Process ()
+{
+    unsigned int header[4];     // sqHead, sqTail, cqHead, cqTail
+    int done = 0;
+
+    busy->P ();
+    while (ReadHeader (header) && header[0] != header[1]
+           && header[1] - header[0] <= RING_ENTRIES
+           && header[3] - header[2] < RING_ENTRIES)
+      {
+        int request[5];         // op, arg1, arg2, arg3, tag
+        int requestAddr = ringAddr + offsetof (Ring, sq)
+            + (header[0] % RING_ENTRIES) * sizeof (RingRequest);
+        int completionAddr = ringAddr + offsetof (Ring, cq)
+            + (header[3] % RING_ENTRIES) * sizeof (RingCompletion);
+        int completion[2];      // tag, result
+        unsigned int next;
+
+        if (!copyIn (requestAddr, request, sizeof (request)))
+            break;
+        for (int i = 0; i < 5; i++)
+            request[i] = WordToHost (request[i]);
+
+        // Consume the request before running it, as it may block
+        next = WordToMachine (header[0] + 1);
+        if (!copyOut (&next, ringAddr + offsetof (Ring, sqHead), sizeof (next)))
+            break;
+
+        completion[0] = WordToMachine (request[4]);
+        completion[1] = WordToMachine (Run (request[0], request[1],
+                                            request[2], request[3]));
+        next = WordToMachine (header[3] + 1);
+        if (!copyOut (completion, completionAddr, sizeof (completion))
+            || !copyOut (&next, ringAddr + offsetof (Ring, cqTail), sizeof (next)))
+            break;
+
+        stats->numRingRequests++;
+        done++;
+      }
+    busy->V ();
+    return done;
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::Run
+//      Run the system call "op" with its arguments, and return its result,
+//      or -1 if it cannot be queued in a ring.
+//----------------------------------------------------------------------
+
+int
+SyscallRing::Run (int op, int arg1, int arg2, int arg3)
+{
+    int args[4] = { arg1, arg2, arg3, 0 };
+
+    switch (op)
+      {
+        case SC_PutChar:
+        case SC_PutString:
+        case SC_Read:
+        case SC_Write:
+        case SC_Yield:
+          return DoSyscall (op, args);
+        default:
+          return -1;
+      }
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::ReadHeader
+//      Read the indexes of the ring into "header".
+//----------------------------------------------------------------------
+
+bool
+SyscallRing::ReadHeader (unsigned int header[4])
+{
+    if (!copyIn (ringAddr, header, 4 * sizeof (unsigned int)))
+        return FALSE;
+    for (int i = 0; i < 4; i++)
+        header[i] = WordToHost (header[i]);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SyscallRing::SetFlags
+//      Publish "flags" in the ring.
+//----------------------------------------------------------------------
+
+void
+SyscallRing::SetFlags (int flags)
+{
+    flags = WordToMachine (flags);
+    (void) copyOut (&flags, ringAddr + offsetof (Ring, flags), sizeof (flags));
+}
+
+#endif // CHANGED
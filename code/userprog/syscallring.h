@@ -0,0 +1,62 @@
+#ifdef CHANGED
+
+// syscallring.h
+//      Batched system calls, through a ring shared with user space.
+//
+//      A process lays out a Ring (see syscall.h) in its own memory and
+//      registers it with RingSetup.  It then queues requests in the ring
+//      without trapping, and a single RingEnter runs all of them, putting
+//      one completion per request back in the ring.
+//
+//      With RING_SQPOLL, a kernel thread in the address space of the
+//      process polls the ring instead, between the other threads.  After
+//      RingPollPasses passes finding nothing, it sets RING_NEED_WAKEUP in
+//      the ring and sleeps until the next RingEnter.
+
+#ifndef SYSCALLRING_H
+#define SYSCALLRING_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define RingPollPasses		4	// empty passes before the poller
+					// goes to sleep
+
+class AddrSpace;
+class Thread;
+class Semaphore;
+
+class SyscallRing:public dontcopythis
+{
+  public:
+    SyscallRing (AddrSpace * space, int address, int flags);
+    ~SyscallRing ();
+
+    static bool IsValid (int ringAddr); // Is there room for a Ring at
+                                // user address "ringAddr"?
+
+    int Enter (void);           // Run the queued requests, or wake the
+                                // poller up.  Return how many were run.
+    void Stop (void);           // Stop the poller, before the address
+                                // space goes away
+    void Poll (void);           // Body of the poller thread
+
+  private:
+    int Process (void);         // Run the queued requests, and return
+                                // how many
+    int Run (int op, int arg1, int arg2, int arg3); // Run one of them
+    bool ReadHeader (unsigned int header[4]);
+    void SetFlags (int flags);
+
+    int ringAddr;               // user address of the Ring
+    Thread *poller;             // NULL unless RING_SQPOLL
+    bool sleeping;              // is the poller waiting on wakeup?
+    bool stopping;              // should the poller finish?
+    Semaphore *busy;            // one Process at a time
+    Semaphore *wakeup;
+    Semaphore *stopped;
+};
+
+#endif // SYSCALLRING_H
+
+#endif // CHANGED
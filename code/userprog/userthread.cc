@@ -0,0 +1,298 @@
+#ifdef CHANGED
+
+// userthread.cc
+//      Routines to create, terminate and wait for the threads of a user
+//      program.
+
+#include "copyright.h"
+#include "system.h"
+#include "userthread.h"
+#include "bitmap.h"
+#include "synch.h"
+#include "syscall.h"
+
+// Initial user registers of a new thread
+struct ThreadStart
+{
+    int pc;
+    int func;
+    int arg;
+    int stack;
+    int slot;
+};
+
+//----------------------------------------------------------------------
+// StartUserThread
+//      First code run by a new thread: set up its registers, as
+//      described by "arg", a ThreadStart, and jump to user code.
+//----------------------------------------------------------------------
+
+static void
+StartUserThread (void *arg)
+{
+    ThreadStart *start = (ThreadStart *) arg;
+
+    for (int i = 0; i < NumTotalRegs; i++)
+        machine->WriteRegister (i, 0);
+    machine->WriteRegister (PCReg, start->pc);
+    machine->WriteRegister (NextPCReg, start->pc + 4);
+    machine->WriteRegister (4, start->arg);
+    machine->WriteRegister (5, start->func);
+    machine->WriteRegister (StackReg, start->stack);
+    machine->WriteRegister (ThreadSlotReg, start->slot);
+    DEBUG ('t', "User thread starts at 0x%x, stack 0x%x\n",
+           start->pc, start->stack);
+    delete start;
+
+    currentThread->space->RestoreState ();
+    machine->Run ();
+    ASSERT_MSG (FALSE, "Machine->Run returned???\n");
+}
+
+//----------------------------------------------------------------------
+// UserThreads::UserThreads
+//      Cut the stack region into slots, the top one being the stack of
+//      the main thread.  A region smaller than a slot is a single slot.
+//----------------------------------------------------------------------
+
+UserThreads::UserThreads (unsigned int bottom, unsigned int top)
+{
+    stackTop = top;
+    slotPages = divRoundUp (UserThreadStackSize, PageSize);
+    numSlots = std::max (1U, (top - bottom) / slotPages);
+    slots = new BitMap (numSlots);
+    lock = new Lock ("user threads");
+    exited = new Condition ("user thread exited");
+
+    UserThread *first = new UserThread;
+    first->id = 0;
+    first->slot = 0;
+    first->thread = NULL;
+    first->exited = first->joined = FALSE;
+    slots->Mark (0);
+    mainSlots = 1;
+    threads.Append (first);
+    nextId = 1;
+    numRunning = 1;
+}
+
+UserThreads::~UserThreads ()
+{
+    UserThread *thread;
+
+    while ((thread = (UserThread *) threads.Remove ()) != NULL)
+        delete thread;
+    delete exited;
+    delete lock;
+    delete slots;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Create
+//      Take a free stack slot, the lowest in memory so that the main
+//      stack keeps room to grow, and start a thread on it in the current
+//      address space.
+//----------------------------------------------------------------------
+
+int
+UserThreads::Create (int startPC, int func, int arg)
+{
+    lock->Acquire ();
+    int slot = slots->FindLast ();
+    if (slot < 0)
+      {
+        lock->Release ();
+        return -1;
+      }
+
+    UserThread *thread = new UserThread;
+    thread->id = nextId++;
+    thread->slot = slot;
+    thread->thread = new Thread ("user thread");
+    thread->exited = thread->joined = FALSE;
+    threads.Append (thread);
+    numRunning++;
+
+    ThreadStart *start = new ThreadStart;
+    start->pc = startPC;
+    start->func = func;
+    start->arg = arg;
+    start->stack = SlotTop (slot) * PageSize - 16;
+    start->slot = slot;
+    thread->thread->space = currentThread->space;
+    thread->thread->Start (StartUserThread, start);
+    stats->numUserThreads++;
+    DEBUG ('t', "User thread %d created in slot %d\n", thread->id, slot);
+    lock->Release ();
+    return thread->id;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Exit
+//      Record "status" for Join, give the stack slots back, and finish
+//      the current thread.  The last thread ends the process instead.
+//----------------------------------------------------------------------
+
+void
+UserThreads::Exit (int status)
+{
+    lock->Acquire ();
+    if (numRunning == 1)
+      {
+        lock->Release ();
+        ExitProcess (status);
+      }
+
+    UserThread *self = Current ();
+    self->status = status;
+    self->exited = TRUE;
+    self->thread = NULL;
+    if (self->id == 0)
+      {
+        for (int slot = 0; slot < mainSlots; slot++)
+            slots->Clear (slot);
+        mainSlots = 0;
+      }
+    else
+        slots->Clear (self->slot);
+    numRunning--;
+    exited->Broadcast (lock);
+    lock->Release ();
+
+    currentThread->space = NULL;	// the others keep it
+    currentThread->Finish ();
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Join
+//      Wait for thread "id" to exit, then forget it and return its
+//      status.  A thread can be joined only once, and not by itself.
+//----------------------------------------------------------------------
+
+int
+UserThreads::Join (int id)
+{
+    lock->Acquire ();
+    UserThread *thread = Find (id);
+    if (thread == NULL || thread->joined || thread == Current ())
+      {
+        lock->Release ();
+        return -1;
+      }
+
+    thread->joined = TRUE;
+    while (!thread->exited)
+        exited->Wait (lock);
+    int status = thread->status;
+    threads.Remove (thread);
+    delete thread;
+    lock->Release ();
+    return status;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::WaitOthers
+//      Called when the process exits: wait for the other threads to
+//      call ThreadExit.
+//----------------------------------------------------------------------
+
+void
+UserThreads::WaitOthers (void)
+{
+    lock->Acquire ();
+    while (numRunning > 1)
+        exited->Wait (lock);
+    lock->Release ();
+}
+
+//----------------------------------------------------------------------
+// UserThreads::SetMain
+//      Called when the process starts running user code on "thread",
+//      alone yet.
+//----------------------------------------------------------------------
+
+void
+UserThreads::SetMain (Thread * thread)
+{
+    Find (0)->thread = thread;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::GrowthLimit
+//      Called on a fault in the stack region.  A thread may back the
+//      pages of its own slot; the main thread may also take the free
+//      slots below its stack, as long as none in between is taken.
+//      The kernel threads of the process own no stack.
+//----------------------------------------------------------------------
+
+unsigned int
+UserThreads::GrowthLimit (unsigned int vpn)
+{
+    unsigned int limit = 0;
+    int slot = SlotOf (vpn);
+
+    lock->Acquire ();
+    UserThread *self = Current ();
+    if (self != NULL && self->id != 0)
+      {
+        if (slot == self->slot)
+            limit = SlotTop (slot);
+      }
+    else if (self != NULL)
+      {
+        while (mainSlots <= slot && !slots->Test (mainSlots))
+            slots->Mark (mainSlots++);
+        if (slot < mainSlots)
+            limit = stackTop;
+      }
+    lock->Release ();
+    return limit;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Current
+//      Return the thread running on currentThread, or NULL if it runs
+//      none, like the syscall ring poller or the I/O thread.
+//----------------------------------------------------------------------
+
+UserThreads::UserThread *
+UserThreads::Current (void)
+{
+    for (ListElement *element = threads.FirstElement (); element; element = element->next)
+      {
+        UserThread *thread = (UserThread *) element->item;
+
+        if (thread->thread == currentThread)
+            return thread;
+      }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Find
+//      Return the thread "id" not joined yet, or NULL.
+//----------------------------------------------------------------------
+
+UserThreads::UserThread *
+UserThreads::Find (int id)
+{
+    for (ListElement *element = threads.FirstElement (); element; element = element->next)
+        if (((UserThread *) element->item)->id == id)
+            return (UserThread *) element->item;
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::SlotOf
+//      Return the slot of stack page "vpn".  The pages below the last
+//      whole slot belong to it.
+//----------------------------------------------------------------------
+
+int
+UserThreads::SlotOf (unsigned int vpn)
+{
+    ASSERT (vpn < stackTop);
+    return std::min ((int) ((stackTop - 1 - vpn) / slotPages), numSlots - 1);
+}
+
+#endif // CHANGED
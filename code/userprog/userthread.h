@@ -0,0 +1,96 @@
+#ifdef CHANGED
+
+// userthread.h
+//      Threads of user programs.
+//
+//      Every thread of a process is a kernel Thread running in the
+//      address space of the process, scheduled like any other.  The
+//      stack region of the address space is cut into slots of
+//      UserThreadStackSize bytes, from the top down: the main thread has
+//      the top one, and ThreadCreate gives each new thread the lowest
+//      free one, which is given back when the thread exits.  The main
+//      thread may still grow its stack past its slot, taking the free
+//      slots below for good.  A thread which overflows its slot runs into the next
+//      one, unless the pages there are not backed yet.
+//
+//      Register ThreadSlotReg ($k1, which compiled code leaves alone)
+//      holds the slot of each thread, 0 for the main thread: the user
+//      runtime finds its per-thread data with it.
+//
+//      A thread keeps its id and exit status until it is joined.  Exit
+//      ends the process once every other thread has called ThreadExit,
+//      and ThreadExit from the last thread left ends the process as well.
+
+#ifndef USERTHREAD_H
+#define USERTHREAD_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+
+#define ThreadSlotReg	27	// holds the stack slot of the thread
+
+class BitMap;
+class Thread;
+class Lock;
+class Condition;
+
+class UserThreads:public dontcopythis
+{
+  public:
+    UserThreads (unsigned int bottom, unsigned int top);
+                                // Threads of the address space with the
+                                // stack region bottom..top-1
+                                // (in pages).  The main thread is there
+                                // already.
+    ~UserThreads ();
+
+    int Create (int startPC, int func, int arg); // Start a thread at user
+                                // address "startPC", with "arg" in r4 and
+                                // "func" in r5.  Return its id, or -1 if
+                                // no stack slot is free.
+    void Exit (int status) __attribute__ ((__noreturn__));
+                                // Terminate the current thread
+    int Join (int id);          // Wait for thread "id" to exit, and
+                                // return its status, or -1
+    void WaitOthers (void);     // Wait until the current thread is the
+                                // last one
+    void SetMain (Thread *thread); // "thread" runs the main thread
+    unsigned int GrowthLimit (unsigned int vpn); // First page past the
+                                // stack of the current thread, if stack
+                                // page "vpn" is part of it, else 0
+
+  private:
+    struct UserThread
+    {
+        int id;
+        int slot;               // its stack slot
+        Thread *thread;         // running it, NULL once it exited
+        int status;
+        bool exited;
+        bool joined;
+    };
+
+    UserThread *Current (void); // The current thread
+    UserThread *Find (int id);  // Thread "id", or NULL
+    int SlotOf (unsigned int vpn); // The slot holding stack page "vpn"
+    unsigned int SlotTop (int slot) // First page past "slot"
+    {
+        return stackTop - slot * slotPages;
+    }
+
+    unsigned int stackTop;
+    unsigned int slotPages;     // pages per slot
+    int numSlots;
+    BitMap *slots;              // slots in use
+    int mainSlots;              // slots 0..mainSlots-1 are the main stack
+    List threads;               // UserThreads not joined yet
+    int nextId;
+    int numRunning;             // threads not exited yet
+    Lock *lock;                 // protects all of the above
+    Condition *exited;          // broadcast when a thread exits
+};
+
+#endif // USERTHREAD_H
+
+#endif // CHANGED